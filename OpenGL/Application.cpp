@@ -3,6 +3,32 @@
 #include <iostream>
 #include "math.h"
 #include "primitives/Shader.h"
+#include "primitives/GLExtensions.h"
+#include "primitives/ShaderCompileQueue.h"
+#include "primitives/ShaderWatcher.h"
+#include "primitives/ShaderRegistry.h"
+#include "primitives/UniformBuffer.h"
+#include "primitives/UniformBlocks.h"
+#include "primitives/GLState.h"
+#include "primitives/VertexFormat.h"
+#include "primitives/VertexArrayCache.h"
+#include "primitives/RenderQueue.h"
+#include "primitives/InstanceBuffer.h"
+#include "primitives/Mesh.h"
+#include "primitives/GeometryArena.h"
+#include "primitives/FramePacer.h"
+#include "geometry/MeshOptimizer.h"
+#include "scene/FrustumCuller.h"
+#include "scene/OcclusionCuller.h"
+#include "core/JobSystem.h"
+#include "core/SPSCQueue.h"
+#include "core/FrameClock.h"
+#include "core/RedrawScheduler.h"
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #define SCREEN_RES_MULTIPLIER 1
 
@@ -10,9 +36,111 @@
 const int windowWidth = 800;
 const int windowHeight = 600;
 
-// This method allows for GLFW to resize the window whenever the user drags the corners
+// Per instance data of Instanced.shader, one per copy of the triangle
+struct InstanceData {
+    float offset[2];
+    float scale;
+    float tint[3];
+};
+
+// Grid of small triangles drawn behind the main one with a single instanced draw
+const int instanceColumns = 40;
+const int instanceRows = 25;
+
+// How many frames the CPU may be ahead of the GPU, 1 to 3. Fewer is less input latency, more keeps both busier
+const int framesInFlight = 2;
+
+// The triangle's vertices are at most this far from its origin
+const float triangleRadius = 0.71f;
+
+// Where a cell of the grid sits, row by row from the bottom left, before the wave moves it
+vec2 gridCell(unsigned int cell) {
+    unsigned int row = cell / instanceColumns, column = cell % instanceColumns;
+    return vec2(-0.975f + 1.95f * (float)column / (instanceColumns - 1), -0.96f + 1.92f * (float)row / (instanceRows - 1));
+}
+
+// What the main thread hands the render thread for every frame
+struct FrameInput {
+    double time; // When the input was read, the frame animates to this
+    int framebufferWidth;
+    int framebufferHeight;
+    bool animating; // Off holds the animation still
+    double wakeTime; // When the main thread woke up from idle for this frame, 0 if it wasn't idle
+    bool quit; // Last one, the render thread cleans up and returns
+};
+
+// The two threads talk only through these. The main thread can read input for the next frame while the current one
+// renders, but no further ahead than that
+const double inputTimeout = 0.1; // The render thread keeps drawing the last input if the main thread is stuck this long
+const double idleTimeout = 1.0; // Idle waits end after this even without events, in case a request got lost
+
+struct FrameChannel {
+    SPSCQueue<FrameInput, 1> frames; // Main -> render
+    SPSCQueue<std::string, 4> titles; // Render -> main, only the main thread may set the window title
+    RedrawScheduler redraws; // Either thread asks for frames here, the main thread decides when to send one
+
+    // The render thread sleeps on this while no frame comes
+    std::mutex mutex;
+    std::condition_variable frameSent;
+
+    // Main thread only. idle is set across an idle wait, the first frame sent during it (from a callback) or after it
+    // carries when the wait ended so the render thread knows the gap before it was sleep
+    bool idle = false;
+    double wakeTime = 0.0;
+
+    bool send(const FrameInput &input) {
+        if (!frames.push(input)) return false;
+        idle = false;
+        wakeTime = 0.0;
+        std::lock_guard<std::mutex> lock(mutex);
+        frameSent.notify_one();
+        return true;
+    }
+};
+
+// Framebuffer size as last reported by GLFW, main thread only. Goes to the render thread with the next frame
+int framebufferWidth = windowWidth * SCREEN_RES_MULTIPLIER;
+int framebufferHeight = windowHeight * SCREEN_RES_MULTIPLIER;
+
+// Input for a frame as of now, main thread only
+FrameInput currentInput(FrameChannel &channel) {
+    double now = glfwGetTime();
+    double wakeTime = channel.idle ? now : channel.wakeTime; // Still in the wait means a callback woke it just now
+    return {now, framebufferWidth, framebufferHeight, channel.redraws.isAnimating(), wakeTime, false};
+}
+
+// This method allows for GLFW to resize the window whenever the user drags the corners. It runs on the main thread,
+// which doesn't have the context, the render thread sets the viewport when the frame gets there. Some platforms
+// don't come back from glfwPollEvents while the window is dragged, so the size goes out right away when there's room,
+// otherwise the main loop sends it. Either way it's one redraw, even when nothing animates
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height); // Set viewport again
+    framebufferWidth = width;
+    framebufferHeight = height;
+    auto* channel = (FrameChannel*)glfwGetWindowUserPointer(window);
+    if (channel && !channel->send(currentInput(*channel))) channel->redraws.requestRedraw();
+}
+
+// Space pauses and resumes the animation, C switches between drawing on demand and every frame. Any key press draws
+// a frame so whatever it changed shows up
+void key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/) {
+    auto* channel = (FrameChannel*)glfwGetWindowUserPointer(window);
+    if (!channel || action != GLFW_PRESS) return;
+
+    if (key == GLFW_KEY_SPACE) {
+        if (channel->redraws.isAnimating()) {
+            channel->redraws.stopAnimation();
+        } else {
+            channel->redraws.startAnimation();
+        }
+    }
+    if (key == GLFW_KEY_C) channel->redraws.setOnDemand(!channel->redraws.isOnDemand());
+    channel->redraws.requestRedraw();
+}
+
+// The window got uncovered or the system lost its contents, draw it again
+void window_refresh_callback(GLFWwindow* window) {
+    auto* channel = (FrameChannel*)glfwGetWindowUserPointer(window);
+    if (channel) channel->redraws.requestRedraw();
 }
 
 // This method processes input, specifically the esc key being pressed
@@ -22,6 +150,320 @@ void processInput(GLFWwindow *window) {
     }
 }
 
+// Render thread. Takes the context, creates the scene and draws a frame for every input the main thread sends until
+// it sends quit
+void run(GLFWwindow *window, FrameChannel *channel) {
+    glfwMakeContextCurrent(window);
+    int viewportWidth = 0, viewportHeight = 0;
+    FrameInput input = {};
+    bool firstFrame = true;
+
+    // CPU side work that splits up (culling for now) runs as jobs on the other cores. This thread helps out while it
+    // waits for them
+    JobSystem jobs;
+
+    // Vertex Data For Object
+    // =========================================================
+//    float vertices[] = { // This are the 3D coordinates for a triangle in NDC (Normalized Device Coordinates -1 to 1)
+//            -0.5f, -0.5f, 0.0f, //x1, y1, z1
+//            0.5f, -0.5f, 0.0f,  //x2, y2, z2
+//            0.0f,  0.5f, 0.0f   //x3, y3, z3
+//    };
+
+    std::vector<float> vertices = {
+            // positions         // colors
+            0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,   // bottom right
+            -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,   // bottom left
+            0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f    // top
+    };
+
+    std::vector<unsigned int> indices = {
+            0,1,2
+    };
+
+    // Reorder for the vertex cache and renumber the vertices by first use
+    MeshOptimizer::Report optimized = MeshOptimizer::optimize(vertices, 6, indices);
+    std::cout << "MESH::OPTIMIZE ACMR " << optimized.before.acmr << " -> " << optimized.after.acmr << ", ATVR "
+              << optimized.before.atvr << " -> " << optimized.after.atvr << std::endl;
+
+    // How the VBO is laid out, attributes are matched to the shader inputs by name so the locations, offsets and
+    // stride don't have to be written down by hand. The VAO is built from this once the shader is ready.
+    // Half float positions and 8 bit colors, 12 bytes a vertex instead of 24, the shader still sees vec3s
+    VertexFormat triangleFormat;
+    triangleFormat.add("aPos", 3, GL_HALF_FLOAT).add("aColor", 3, GL_UNSIGNED_BYTE, true);
+
+    // Meshes of this format share one big vertex buffer and one index buffer, each gets a range of them instead of
+    // its own buffer objects and all draw through the arena's VAO
+    GeometryArena sceneGeometry(triangleFormat, 1 << 16, 1 << 18);
+
+    // The mesh frees its ranges when it goes out of scope, and the draw count comes from the index data instead of
+    // being written by hand
+    Mesh triangle(sceneGeometry);
+    unsigned int triangleMesh = triangle.add(triangleFormat.pack(vertices.data(), optimized.vertexCount), indices);
+    triangle.upload();
+
+    RangeAllocator::Stats vertexStats = sceneGeometry.getVertices().stats();
+    std::cout << "ARENA::VERTICES " << vertexStats.used << "/" << vertexStats.capacity << " in "
+              << vertexStats.allocations << " ranges, fragmentation " << vertexStats.fragmentation << std::endl;
+
+    VertexArrayCache vertexArrays;
+    RenderQueue renderQueue; // Draws are collected here and sorted by state before anything reaches GL
+    // Draws recorded by jobs, one per thread. The extra one at getThreadCount() is for threads outside the job system,
+    // jobs started there run inline and record there
+    std::vector<CommandBuffer> threadCommands(jobs.getThreadCount() + 1);
+
+    // The instanced grid reads the same VBO plus one element of the instance buffer per copy
+    VertexFormat instanceFormat;
+    instanceFormat.add("aOffset", 2).add("aScale", 1).add("aTint", 3).perInstance();
+    InstanceBuffer<InstanceData> instances(instanceColumns * instanceRows);
+    unsigned int instancedVAOs[InstanceBuffer<InstanceData>::PARTITIONS] = {}; // One per ring partition
+    int instancedFormatRevision = 0;
+
+    // Bounding spheres of the grid cells. The wave moves them by at most 0.01, that goes into the radius so the cells
+    // can stay in a BVH built once
+    FrustumCuller gridCulling;
+    for (unsigned int cell = 0; cell < (unsigned int)(instanceColumns * instanceRows); cell++) {
+        gridCulling.add(vec3(gridCell(cell), 0.0f), 0.03f * triangleRadius + 0.01f);
+    }
+    gridCulling.buildHierarchy();
+    std::vector<unsigned int> visibleCells;
+
+    // The triangle sits in front of the grid and hides the cells behind it, they aren't submitted at all. It's drawn
+    // into a small CPU depth buffer every frame and the cells that passed the frustum are tested against that
+    OcclusionCuller occlusion(256, 128, &jobs);
+    std::vector<vec3> trianglePositions;
+    for (size_t vertex = 0; vertex < optimized.vertexCount; vertex++) {
+        trianglePositions.push_back(vec3(vertices[vertex * 6], vertices[vertex * 6 + 1], vertices[vertex * 6 + 2]));
+    }
+
+    // Render Loop
+    // =========================================================
+    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Set wireframe mode
+
+    Shader::setBinaryCacheDirectory("shadercache"); // Linked programs are reused across launches
+
+    // Shaders compile in the background, frames show up right away and draws start once their program is ready.
+    // Edits to the shader files are picked up while the app runs
+    ShaderCompileQueue compileQueue;
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.setOnChange([channel] { channel->redraws.requestRedraw(); }); // An edit shows up even when idle
+    ShaderRegistry shaders(&compileQueue, &shaderWatcher);
+
+    Shader &basicShader = shaders.get("../../OpenGL/resources/shaders/Default.shader");
+    Shader &instancedShader = shaders.get("../../OpenGL/resources/shaders/Instanced.shader");
+
+    // Shared data goes through uniform buffers: one upload per frame for FrameData, and all the objects of a frame
+    // packed into one ObjectData buffer where every draw binds its own range
+    UniformBlock<FrameData> frameUniforms("FrameData");
+    UniformArray<ObjectData> objectUniforms("ObjectData", 1024);
+
+    frameUniforms.data.view = mat4::identity();
+    frameUniforms.data.projection = mat4::identity();
+
+    // Once a second the window title shows how many GL state calls the last frame made and how many were skipped,
+    // and how many state switches sorting the draws saved
+    double statsTime = glfwGetTime();
+
+    // Animation runs in fixed steps on the frame clock, frames draw between the last two. The triangle's orbit is
+    // simulation state, the grid wave and the shaders just follow the render time
+    FrameClock clock;
+    FramePacer pacer(framesInFlight);
+    float triangleAngle = 0.0f;
+    Interpolated<vec4> triangleOffset(vec4(0.25f, 0.0f, -0.5f, 0.0f));
+    Interpolated<float> animationTime(0.0f); // Stops while paused, unlike the clock
+    bool wasAnimating = true;
+
+    while (true) {
+        // Next frame's input. The main thread is usually ahead already, if not it's about to be. While something
+        // animates and the main thread is stuck in an event, the last input is drawn again at the current time.
+        // Otherwise this sleeps until a frame is sent, which on demand can be a long time
+        bool fresh;
+        {
+            std::unique_lock<std::mutex> lock(channel->mutex);
+            auto received = [&] { return channel->frames.pop(input); };
+            if (!firstFrame && (!channel->redraws.isOnDemand() || channel->redraws.isAnimating())) {
+                fresh = channel->frameSent.wait_for(lock, std::chrono::duration<double>(inputTimeout), received);
+            } else {
+                channel->frameSent.wait(lock, received);
+                fresh = true;
+            }
+        }
+        if (fresh) {
+            glfwPostEmptyEvent(); // A slot is free again, wake the main thread if it's waiting for one
+        } else {
+            input.time = glfwGetTime();
+        }
+        if (input.quit) break;
+        firstFrame = false;
+
+        // Resizes are picked up here, the callback can't touch GL
+        if (input.framebufferWidth != viewportWidth || input.framebufferHeight != viewportHeight) {
+            viewportWidth = input.framebufferWidth;
+            viewportHeight = input.framebufferHeight;
+            GLState::setViewport(0, 0, viewportWidth, viewportHeight);
+        }
+
+        // Hold the frame back if the GPU is more than framesInFlight behind, nothing it reads gets touched before this
+        pacer.beginFrame();
+
+        // Finish any shader the driver is done with
+        compileQueue.poll();
+        shaderWatcher.update();
+        if (!compileQueue.empty()) channel->redraws.requestRedraw(); // Keep frames coming until the programs are in
+
+        // Per frame data
+        // Paused frames hold everything still, and a resumed animation doesn't try to catch up on the pause. A frame
+        // that woke the loop from idle follows a gap of sleep, not of work, it's kept out of the frame times
+        unsigned int steps = clock.tick(input.time, input.wakeTime > 0.0);
+        if (!input.animating || !wasAnimating) {
+            steps = 0;
+            triangleOffset.step(triangleOffset.current);
+            animationTime.step(animationTime.current);
+        }
+        wasAnimating = input.animating;
+        for (unsigned int step = 0; step < steps; step++) {
+            triangleAngle += (float)clock.getFixedStep();
+            triangleOffset.step(vec4(cos(triangleAngle)/4, sin(triangleAngle)/4, -0.5f, 0.0f));
+            animationTime.step(animationTime.current + (float)clock.getFixedStep());
+        }
+
+        auto time = animationTime.at(clock.getAlpha());
+        frameUniforms.data.time = time;
+        frameUniforms.upload();
+
+        objectUniforms.clear();
+        ObjectData triangleData = {triangleOffset.at(clock.getAlpha())};
+        size_t triangleSlot = objectUniforms.push(triangleData);
+        objectUniforms.upload();
+
+        // Only what the camera can see gets submitted
+        Frustum frustum = Frustum::fromMatrix(frameUniforms.data.projection * frameUniforms.data.view);
+        gridCulling.cull(frustum, visibleCells);
+
+        // ... and isn't hidden behind the triangle
+        occlusion.beginFrame(frameUniforms.data.projection * frameUniforms.data.view);
+        occlusion.addOccluder(mat4::translate(triangleData.offset.xyz()), trianglePositions.data(), indices.data(),
+                              indices.size(), true); // A lone flat triangle, wound clockwise at that
+        occlusion.rasterize();
+        float cellExtent = 0.03f * triangleRadius + 0.01f;
+        visibleCells.erase(std::remove_if(visibleCells.begin(), visibleCells.end(), [&](unsigned int cell) {
+            vec3 center(gridCell(cell), 0.0f);
+            return !occlusion.isVisible(center - vec3(cellExtent, cellExtent, 0.0f),
+                                        center + vec3(cellExtent, cellExtent, 0.0f));
+        }), visibleCells.end());
+
+        // Instance data is rebuilt and streamed every frame straight into a mapped ring buffer
+        instances.clear(); // Waits (rarely) for the GPU to be done with the partition two frames back
+        for (unsigned int cell : visibleCells) {
+            vec2 position = gridCell(cell);
+            float wave = sin(time * 2.0f + position.x * 4.0f + position.y * 3.0f);
+            instances.push({{position.x, position.y + wave * 0.01f}, 0.03f, {0.4f + 0.2f * wave, 0.4f, 0.5f}});
+        }
+        instances.upload();
+
+        // Render commands ...
+        glClearColor(0.27f, 0.27f, 0.27f, 1.0f); // Paints it red
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // Skip the draw until the program has linked, or while the triangle is out of view. VAOs are GL objects, they
+        // are looked up here on the context thread before any recording starts
+        bool drawTriangle = basicShader.isReady() && frustum.containsSphere(triangleData.offset.xyz(), triangleRadius);
+        unsigned int triangleVAO = drawTriangle ? triangle.prepare(basicShader) : 0; // A reload can move the inputs
+
+        bool drawGrid = instancedShader.isReady() && !visibleCells.empty();
+        if (drawGrid && instancedFormatRevision != instancedShader.getRevision()) {
+            VertexFormat vertexInputs = triangleFormat.resolve(instancedShader);
+            VertexFormat instanceInputs = instanceFormat.resolve(instancedShader);
+            for (int partition = 0; partition < InstanceBuffer<InstanceData>::PARTITIONS; partition++) {
+                size_t offset = partition * instances.getStream().getPartitionSize();
+                instancedVAOs[partition] = vertexArrays.get({{vertexInputs, triangle.getVertexBuffer(), 0},
+                                                             {instanceInputs, instances.getID(), offset}},
+                                                            triangle.getIndexBuffer());
+            }
+            instancedFormatRevision = instancedShader.getRevision();
+        }
+        unsigned int instancedVAO = instancedVAOs[instances.getPartition()];
+
+        // Filling in the draws is plain CPU work, each object is a job and its draws go into the command buffer of
+        // whichever thread runs it. Only the replay below talks to GL
+        JobCounter recording;
+        if (drawTriangle) {
+            jobs.run([&] {
+                DrawCommand triangleDraw{};
+                triangle.fill(triangleDraw, triangleMesh); // The VAO already remembers the EBO, no need to bind it again
+                triangleDraw.program = basicShader.ID;
+                triangleDraw.uniformBuffer = objectUniforms.getBuffer().getID();
+                triangleDraw.uniformBinding = objectUniforms.getBuffer().getBindingPoint();
+                triangleDraw.uniformOffset = (unsigned int)objectUniforms.offsetOf(triangleSlot);
+                triangleDraw.uniformSize = sizeof(ObjectData);
+                triangleDraw.mode = GL_TRIANGLES;
+                threadCommands[jobs.getThreadIndex()].submit(
+                        triangleDraw, RenderQueue::makeKey(1, basicShader.ID, triangleVAO, 0, 0.0f));
+            }, &recording);
+        }
+        if (drawGrid) {
+            jobs.run([&] {
+                DrawCommand gridDraw{};
+                triangle.fill(gridDraw, triangleMesh);
+                gridDraw.program = instancedShader.ID;
+                gridDraw.vertexArray = instancedVAO; // Same buffers, plus the instance stream
+                gridDraw.mode = GL_TRIANGLES;
+                gridDraw.instanceCount = (int)instances.size();
+                threadCommands[jobs.getThreadIndex()].submit(
+                        gridDraw, RenderQueue::makeKey(0, instancedShader.ID, instancedVAO, 0, 0.0f));
+            }, &recording);
+        }
+        jobs.wait(recording);
+
+        for (const CommandBuffer &commands : threadCommands) renderQueue.merge(commands);
+        renderQueue.flush();
+        for (CommandBuffer &commands : threadCommands) commands.reset();
+        instances.fence(); // The GPU is done with this frame's instances once it gets past here
+
+        GLState::Stats stateStats = GLState::endFrame();
+        if (input.time - statsTime > 1.0) {
+            statsTime = input.time;
+            const RenderQueue::Stats &queueStats = renderQueue.lastStats();
+            FrameClock::Percentiles frameTimes = clock.getPercentiles();
+            FramePacer::Stats paceStats = pacer.takeStats();
+            RedrawScheduler::Stats redrawStats = channel->redraws.getStats();
+            std::string title = "My Window | state calls " + std::to_string(stateStats.calls) +
+                                ", redundant skipped " + std::to_string(stateStats.filtered) +
+                                " | draws " + std::to_string(queueStats.draws) + " for " +
+                                std::to_string(queueStats.instances) + " objects, switches " +
+                                std::to_string(queueStats.stateChangesSorted) + " (unsorted " +
+                                std::to_string(queueStats.stateChangesSubmitted) + ") | culled " +
+                                std::to_string(gridCulling.lastStats().culled) + " of " +
+                                std::to_string(gridCulling.lastStats().objects) + " cells, occluded " +
+                                std::to_string(occlusion.lastStats().occluded) + " in " +
+                                std::to_string(occlusion.lastStats().rasterMilliseconds) + " ms | frame p50 " +
+                                std::to_string(frameTimes.p50) + " p95 " + std::to_string(frameTimes.p95) + " p99 " +
+                                std::to_string(frameTimes.p99) + " ms | GPU wait " +
+                                std::to_string(paceStats.waitedFrames) + " of " + std::to_string(paceStats.frames) +
+                                " frames, " + std::to_string(paceStats.waitMilliseconds) + " ms (max " +
+                                std::to_string(paceStats.maxWaitMilliseconds) + ", " +
+                                std::to_string(pacer.getFramesInFlight()) + " in flight) | " +
+                                (channel->redraws.isOnDemand() ? "on demand" : "continuous") + ", idle CPU " +
+                                std::to_string(redrawStats.idleCpuPercent) + "% over " +
+                                std::to_string(redrawStats.idleSeconds) + " s, wake up " +
+                                std::to_string(redrawStats.wakeMilliseconds) + " ms (max " +
+                                std::to_string(redrawStats.maxWakeMilliseconds) + ")";
+            channel->titles.push(std::move(title)); // Dropped if the main thread is behind, there's another in a second
+        }
+
+        // Swap buffers, waiting here for vsync doesn't hold up input anymore
+        glfwSwapBuffers(window); // Applies a double buffer for a crisp image.
+        pacer.endFrame();
+
+        if (input.wakeTime > 0.0) {
+            channel->redraws.recordWake((glfwGetTime() - input.wakeTime) * 1000.0);
+            input.wakeTime = 0.0; // Redraws of the same input don't count
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
 int main() {
 
     // Initialize GLFW for it to properly work
@@ -56,98 +498,69 @@ int main() {
         return -1;
     }
 
+    // Load the entry points newer than 3.3 that we use when the driver has them
+    GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+
     // Set actual viewport dimension
     // Takes 4 parameters, left-x, bottom-y, right-x, top-y. y=0,x=0 is the bottom left corner of the viewport.
-    glViewport(0, 0, windowWidth*SCREEN_RES_MULTIPLIER, windowHeight*SCREEN_RES_MULTIPLIER); // Used for mapping from -1 to 1 to the actual render size.
+    GLState::setViewport(0, 0, windowWidth*SCREEN_RES_MULTIPLIER, windowHeight*SCREEN_RES_MULTIPLIER); // Used for mapping from -1 to 1 to the actual render size.
 
     // Tell GLFW that we have a viewportResize callback function, in case the event occurs it can resize it.
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     /* IMPORTANT: Any other callback function that needs to be registered has to happen between the window creation
      * and before the render loop */
 
-    // Vertex Data For Object
-    // =========================================================
-//    float vertices[] = { // This are the 3D coordinates for a triangle in NDC (Normalized Device Coordinates -1 to 1)
-//            -0.5f, -0.5f, 0.0f, //x1, y1, z1
-//            0.5f, -0.5f, 0.0f,  //x2, y2, z2
-//            0.0f,  0.5f, 0.0f   //x3, y3, z3
-//    };
-
-    float vertices[] = {
-            // positions         // colors
-            0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,   // bottom right
-            -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,   // bottom left
-            0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f    // top
-    };
-
-    int indices[] = {
-            0,1,2
-    };
-
-    // This creates a vertex buffer object
-    unsigned int VBO, VAO, EBO; // Vertex Buffer Object, Vertex Array Object, Element Buffer Object
-    glGenVertexArrays(1, &VAO); // Generate a Vertex Array Object to store all those settings below for this particular VBO
-    glGenBuffers(1, &VBO); // This methods binds our var to the VBO created behind the scenes
-    glGenBuffers(1, &EBO); // Creates EBO and returns ID
-
-    // Bind VAO so it registers EBO and VBO when doing changes
-    glBindVertexArray(VAO); // Its important to first bind the VAO so VBO registers in it
-
-    // Bind VBO and fill it with data
-    glBindBuffer(GL_ARRAY_BUFFER, VBO); // Binds it to GL_ARRAY_BUFFER, so any further operations on it are on VBO
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW); //Fills VBO with our data
-
-    // Bind EBO and fill it with data
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO); // Binds the EBO
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW); // Fills the buffer with the corresponding data
-
-    // Tell openGL gow to interpret our VBO ------------
-
-    // First argument specifies the index (location=0) in our shader so we use 0
-    // Second argument is the length of the value location is a vec3 so 3
-    // Third is the type of the data
-    // Fourth is a setting that clamps values between -1 and 1 or 0 and 1 for unsigned.
-    // Fifth: Stride, the length between each distinct value (x i i x i i x i i) <- for that it would be 3
-    // Sixth: Starting offset for the value (i i x) <- offset would be 2 as it starts later
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0); // Set interpretation of VBO
-    glEnableVertexAttribArray(0); // Enables the attribute number (Defined in the vertex shader as (location=0)
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3*sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Render Loop
-    // =========================================================
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Set wireframe mode
-
-    Shader basicShader("../../OpenGL/resources/shaders/Default.shader");
-    basicShader.use();
-
+    // The render thread gets the context from here on, GL objects are created and destroyed over there
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glfwMakeContextCurrent(nullptr);
+    FrameChannel channel;
+    channel.redraws.setWake(glfwPostEmptyEvent); // Requests from other threads get the main thread out of its wait
+    channel.redraws.startAnimation(); // The triangle orbits and the grid waves until space pauses them
+    glfwSetWindowUserPointer(window, &channel);
+    std::thread renderThread(run, window, &channel);
+
+    // Main thread: events and input only, so a slow swap doesn't delay input and dragging the window doesn't stall
+    // rendering. Every pass hands the render thread the input of one frame
+    // When nothing animates and nobody asked for a frame, it sleeps in the event queue instead and the render thread
+    // sleeps too, nothing gets drawn until input or a request comes in
     while(!glfwWindowShouldClose(window)) // Checks if the window has been instructed to close, if true loop terminates.
     {
-        // Manage input
+        if (channel.redraws.hasWork()) {
+            glfwPollEvents(); // Checks for events that may occur during runtime.
+        } else {
+            channel.redraws.beginIdle(glfwGetTime());
+            channel.idle = true;
+            glfwWaitEventsTimeout(idleTimeout);
+            double now = glfwGetTime();
+            if (channel.idle) { // No callback sent a frame for this wake up yet
+                channel.idle = false;
+                channel.wakeTime = now;
+            }
+            channel.redraws.endIdle(now);
+        }
         processInput(window);
 
-        // Render commands ...
-        glClearColor(0.27f, 0.27f, 0.27f, 1.0f); // Paints it red
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        basicShader.use();
-        basicShader.setUniformFloat("dx", cos((float)glfwGetTime())/4);
-        basicShader.setUniformFloat("dy", sin((float)glfwGetTime())/4);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        std::string title;
+        while (channel.titles.pop(title)) glfwSetWindowTitle(window, title.c_str());
 
-        // Manage events and swap buffers
-        glfwSwapBuffers(window); // Applies a double buffer for a crisp image.
-        glfwPollEvents(); // Checks for events that may occur during runtime.
+        // Render thread is still on the last frame, sleep until it takes that one or an event comes in
+        if (channel.frames.full()) {
+            glfwWaitEvents();
+            continue;
+        }
+        if (!channel.redraws.takeFrame()) continue;
+        channel.send(currentInput(channel));
     }
 
-    // Clean additional resources
-    // =========================================================
-    glDeleteBuffers(1, &VBO);
-    glDeleteVertexArrays(1, &VAO);
+    // Everything holding GL objects lives in run, so it's all destroyed before the context goes away
+    glfwSetWindowUserPointer(window, nullptr); // No more frames from the callback after quit
+    FrameInput last = currentInput(channel);
+    last.quit = true;
+    while (!channel.send(last)) glfwWaitEvents();
+    renderThread.join();
 
     //Once loop is done we want to properly terminate and remove resources (clean memory and shit).
     glfwTerminate(); // This function does exactly that ^^^
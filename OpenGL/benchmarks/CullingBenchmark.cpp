@@ -0,0 +1,183 @@
+// Culling of a big static scene over a camera going round it. Frustum: the linear SIMD pass against the BVH, the time
+// per cull and how many spheres were tested and culled. Occlusion: what's left after the frustum, checked against a
+// few hundred buildings rasterized as occluders, without and with a job system splitting the bands. Both checks have
+// to agree with each other (exits with 1 if not, ctest runs it small). No GL or window needed. Run with an optional
+// object count
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../core/JobSystem.h"
+#include "../scene/FrustumCuller.h"
+#include "../scene/OcclusionCuller.h"
+
+static const int repetitions = 5; // Best of
+static const int views = 16; // Camera positions per run
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Objects spread over a 400 unit wide field, a city more than a cloud: wide and low
+struct Scene {
+    std::vector<vec3> centers;
+    std::vector<float> radii;
+    std::vector<mat4> buildings; // Unit cube to world
+};
+
+static Scene scatter(size_t count) {
+    Scene scene;
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> ground(-200.0f, 200.0f), height(0.0f, 20.0f), size(0.5f, 4.0f);
+    for (size_t i = 0; i < count; i++) {
+        scene.centers.push_back(vec3(ground(random), height(random), ground(random)));
+        scene.radii.push_back(size(random));
+    }
+    std::uniform_real_distribution<float> width(3.0f, 10.0f), tall(10.0f, 40.0f);
+    for (int i = 0; i < 300; i++) {
+        vec3 half(width(random), tall(random), width(random));
+        vec3 center(ground(random), half.y, ground(random));
+        scene.buildings.push_back(mat4::translate(center) * mat4::scale(half));
+    }
+    return scene;
+}
+
+// Standing inside the field looking outward, each view a bit further round
+static mat4 view(int index) {
+    float angle = 2.0f * 3.14159265f * (float)index / (float)views;
+    vec3 eye(60.0f * std::cos(angle), 10.0f, 60.0f * std::sin(angle));
+    vec3 target = eye + vec3(-std::sin(angle), -0.1f, std::cos(angle));
+    return mat4::perspective(1.0f, 16.0f / 9.0f, 0.1f, 250.0f) * mat4::lookAt(eye, target, vec3(0.0f, 1.0f, 0.0f));
+}
+
+struct Result {
+    double milliseconds = 1e30; // Per cull
+    unsigned long long tested = 0;
+    unsigned long long culled = 0;
+};
+
+static Result benchmark(FrustumCuller &culler, std::vector<std::vector<unsigned int>> &visible) {
+    Result result;
+    for (int run = 0; run < repetitions; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < views; i++) culler.cull(Frustum::fromMatrix(view(i)), visible[i]);
+        result.milliseconds = std::min(result.milliseconds, since(start) / views);
+    }
+    for (int i = 0; i < views; i++) {
+        culler.cull(Frustum::fromMatrix(view(i)), visible[i]);
+        result.tested += culler.lastStats().tested;
+        result.culled += culler.lastStats().culled;
+    }
+    return result;
+}
+
+// The -1..1 cube, counter clockwise seen from outside
+static const vec3 cube[8] = {vec3(-1, -1, -1), vec3(1, -1, -1), vec3(-1, 1, -1), vec3(1, 1, -1),
+                             vec3(-1, -1, 1), vec3(1, -1, 1), vec3(-1, 1, 1), vec3(1, 1, 1)};
+static const unsigned int cubeIndices[36] = {1, 3, 7, 1, 7, 5, 0, 4, 6, 0, 6, 2, 2, 6, 7, 2, 7, 3,
+                                             0, 1, 5, 0, 5, 4, 4, 5, 7, 4, 7, 6, 0, 2, 3, 0, 3, 1};
+
+struct OcclusionResult {
+    double rasterMilliseconds = 1e30; // Per view, adding the occluders through the pyramid
+    double testMilliseconds = 1e30; // Per view, all the frustum visible boxes
+    unsigned long long triangles = 0;
+    unsigned long long tested = 0;
+    unsigned long long occluded = 0;
+    std::vector<std::vector<bool>> visible; // Per view, per frustum visible object
+};
+
+static OcclusionResult benchmarkOcclusion(const Scene &scene, const std::vector<std::vector<unsigned int>> &candidates,
+                                          JobSystem* jobs) {
+    OcclusionCuller culler(256, 128, jobs); // What Application uses
+    OcclusionResult result;
+    result.visible.resize(views);
+    for (int run = 0; run < repetitions; run++) {
+        double raster = 0.0, test = 0.0;
+        result.triangles = result.tested = result.occluded = 0;
+        for (int i = 0; i < views; i++) {
+            auto start = std::chrono::steady_clock::now();
+            culler.beginFrame(view(i));
+            for (const mat4 &building : scene.buildings) culler.addOccluder(building, cube, cubeIndices, 36);
+            culler.rasterize();
+            raster += since(start);
+
+            start = std::chrono::steady_clock::now();
+            std::vector<bool> &visible = result.visible[i];
+            visible.clear();
+            for (unsigned int id : candidates[i]) {
+                vec3 extent(scene.radii[id]);
+                visible.push_back(culler.isVisible(scene.centers[id] - extent, scene.centers[id] + extent));
+            }
+            test += since(start);
+
+            result.triangles += culler.lastStats().occluderTriangles;
+            result.tested += culler.lastStats().tested;
+            result.occluded += culler.lastStats().occluded;
+        }
+        result.rasterMilliseconds = std::min(result.rasterMilliseconds, raster / views);
+        result.testMilliseconds = std::min(result.testMilliseconds, test / views);
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t count = 100000;
+    if (argc > 1) count = (size_t)std::max(1, std::atoi(argv[1]));
+
+    Scene scene = scatter(count);
+    FrustumCuller linear, hierarchy;
+    for (size_t i = 0; i < count; i++) {
+        linear.add(scene.centers[i], scene.radii[i]);
+        hierarchy.add(scene.centers[i], scene.radii[i]);
+    }
+    auto start = std::chrono::steady_clock::now();
+    hierarchy.buildHierarchy();
+    double build = since(start);
+
+    std::vector<std::vector<unsigned int>> linearVisible(views), hierarchyVisible(views);
+    Result linearResult = benchmark(linear, linearVisible);
+    Result hierarchyResult = benchmark(hierarchy, hierarchyVisible);
+
+    bool same = true;
+    for (int i = 0; i < views; i++) {
+        std::sort(hierarchyVisible[i].begin(), hierarchyVisible[i].end());
+        same &= hierarchyVisible[i] == linearVisible[i];
+    }
+
+    std::cout << count << " objects, " << views << " views, best of " << repetitions << ", SSE " << MATH_SSE
+              << ", AVX " << MATH_AVX << std::endl;
+    std::cout << "frustum | ms per cull | tested per cull | culled per cull" << std::endl;
+    std::cout << "linear | " << linearResult.milliseconds << " | " << linearResult.tested / views << " | "
+              << linearResult.culled / views << std::endl;
+    std::cout << "BVH | " << hierarchyResult.milliseconds << " | " << hierarchyResult.tested / views << " | "
+              << hierarchyResult.culled / views << std::endl;
+    std::cout << "BVH build " << build << " ms, culls x" << linearResult.milliseconds / hierarchyResult.milliseconds
+              << " faster" << std::endl;
+
+    // Occlusion on what the frustum left, in id order so the two runs line up
+    OcclusionResult single = benchmarkOcclusion(scene, linearVisible, nullptr);
+    JobSystem jobs;
+    OcclusionResult threaded = benchmarkOcclusion(scene, linearVisible, &jobs);
+    std::cout << "occlusion | raster ms per view | test ms per view | occluder triangles | tested | occluded" << std::endl;
+    for (const OcclusionResult* result : {&single, &threaded}) {
+        std::cout << (result == &single ? "1 thread" : "job system") << " | " << result->rasterMilliseconds << " | "
+                  << result->testMilliseconds << " | " << result->triangles / views << " | " << result->tested / views
+                  << " | " << result->occluded / views << std::endl;
+    }
+    std::cout << "job system of " << jobs.getThreadCount() << " threads, raster speedup x"
+              << single.rasterMilliseconds / threaded.rasterMilliseconds << std::endl;
+
+    if (!same) {
+        std::cout << "ERROR::BENCHMARK::CULLING the BVH and the linear pass disagree" << std::endl;
+        return 1;
+    }
+    if (single.visible != threaded.visible || single.occluded == 0) {
+        std::cout << "ERROR::BENCHMARK::CULLING occlusion differs with the job system, or hides nothing" << std::endl;
+        return 1;
+    }
+    return 0;
+}
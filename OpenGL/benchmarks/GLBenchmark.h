@@ -0,0 +1,91 @@
+#ifndef LEARNOPENGL_GLBENCHMARK_H
+#define LEARNOPENGL_GLBENCHMARK_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <string>
+#include "../primitives/GLExtensions.h"
+
+// For the benchmarks that need a GPU: a hidden window with a 3.3 core context, current on the creating thread.
+// Everything holding GL objects has to be gone before this is
+class GLBenchmark {
+public:
+    GLBenchmark(int width, int height) {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        window = glfwCreateWindow(width, height, "Benchmark", nullptr, nullptr);
+        if (window == nullptr) {
+            std::cout << "ERROR::BENCHMARK::NO_WINDOW needs a display with GL 3.3" << std::endl;
+            return;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cout << "ERROR::BENCHMARK::GLAD failed to initialize" << std::endl;
+            glfwDestroyWindow(window);
+            window = nullptr;
+            return;
+        }
+        GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+        glViewport(0, 0, width, height);
+    }
+
+    ~GLBenchmark() {
+        if (window != nullptr) glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    GLBenchmark(const GLBenchmark&) = delete;
+    GLBenchmark &operator=(const GLBenchmark&) = delete;
+
+    bool isOpen() const {
+        return window != nullptr;
+    }
+
+    // The shaders come from the source tree (CMake sets OPENGL_SOURCE_DIR), the benchmarks run from anywhere
+    static std::string shaderPath(const char* name) {
+        return std::string(OPENGL_SOURCE_DIR) + "/resources/shaders/" + name;
+    }
+
+private:
+    GLFWwindow* window = nullptr;
+};
+
+// GPU time of the commands issued between begin and end (GL_TIME_ELAPSED, core in 3.3)
+class GPUTimer {
+public:
+    GPUTimer() {
+        glGenQueries(1, &query);
+    }
+
+    ~GPUTimer() {
+        glDeleteQueries(1, &query);
+    }
+
+    GPUTimer(const GPUTimer&) = delete;
+    GPUTimer &operator=(const GPUTimer&) = delete;
+
+    void begin() {
+        glBeginQuery(GL_TIME_ELAPSED, query);
+    }
+
+    // Waits for the GPU to get there
+    double end() {
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        return (double)nanoseconds / 1e6;
+    }
+
+private:
+    unsigned int query = 0;
+};
+
+#endif //LEARNOPENGL_GLBENCHMARK_H
@@ -0,0 +1,171 @@
+// 100k copies of a small triangle, drawn the way the scene did before instancing (per object: bind its uniform range,
+// glDrawElements) against one glDrawElementsInstanced reading a streamed instance buffer. Reports the CPU time to
+// submit, the whole frame through glFinish and the GPU time. Opens a hidden window, needs GL 3.3. Run with an optional
+// instance count
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "GLBenchmark.h"
+#include "../primitives/GLState.h"
+#include "../primitives/InstanceBuffer.h"
+#include "../primitives/Shader.h"
+#include "../primitives/UniformBlocks.h"
+#include "../primitives/UniformBuffer.h"
+#include "../primitives/VertexArrayCache.h"
+#include "../primitives/VertexFormat.h"
+
+static const int frames = 10; // Best of, the first frames warm up the driver
+
+// Same layout as the grid in Application
+struct InstanceData {
+    float offset[2];
+    float scale;
+    float tint[3];
+};
+
+struct Timing {
+    double submitMilliseconds = 1e30; // CPU, until the last call returns
+    double frameMilliseconds = 1e30; // CPU, through glFinish
+    double gpuMilliseconds = 1e30;
+
+    void keepBest(double submit, double frame, double gpu) {
+        submitMilliseconds = std::min(submitMilliseconds, submit);
+        frameMilliseconds = std::min(frameMilliseconds, frame);
+        gpuMilliseconds = std::min(gpuMilliseconds, gpu);
+    }
+};
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Where copy i goes, a grid over the whole viewport
+static void gridPosition(size_t i, size_t count, float &x, float &y) {
+    size_t columns = 1;
+    while (columns * columns < count) columns++;
+    x = -1.0f + 2.0f * ((float)(i % columns) + 0.5f) / (float)columns;
+    y = -1.0f + 2.0f * ((float)(i / columns) + 0.5f) / (float)columns;
+}
+
+static int run(size_t count) {
+    // A triangle small enough that rasterizing 100k of them costs next to nothing, what's left is submission
+    const float size = 0.005f;
+    const float vertices[] = {
+            size, -size, 0.0f, 1.0f, 0.0f, 0.0f,
+            -size, -size, 0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, size, 0.0f, 0.0f, 0.0f, 1.0f
+    };
+    const unsigned short indices[] = {0, 1, 2};
+
+    VertexFormat triangleFormat;
+    triangleFormat.add("aPos", 3, GL_HALF_FLOAT).add("aColor", 3, GL_UNSIGNED_BYTE, true);
+    std::vector<unsigned char> vertexData = triangleFormat.pack(vertices, 3);
+
+    unsigned int buffers[2];
+    glGenBuffers(2, buffers);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    Shader perDrawShader(GLBenchmark::shaderPath("Default.shader").c_str());
+    Shader instancedShader(GLBenchmark::shaderPath("Instanced.shader").c_str());
+    if (!perDrawShader.isReady() || !instancedShader.isReady()) {
+        std::cout << "ERROR::BENCHMARK::SHADERS didn't build" << std::endl;
+        glDeleteBuffers(2, buffers);
+        return 1;
+    }
+
+    UniformBlock<FrameData> frameUniforms("FrameData");
+    frameUniforms.data.view = mat4::identity();
+    frameUniforms.data.projection = mat4::identity();
+    frameUniforms.upload();
+    UniformArray<ObjectData> objectUniforms("ObjectData", count);
+
+    VertexFormat instanceFormat;
+    instanceFormat.add("aOffset", 2).add("aScale", 1).add("aTint", 3).perInstance();
+    InstanceBuffer<InstanceData> instances(count);
+
+    VertexArrayCache vertexArrays;
+    unsigned int perDrawVAO = vertexArrays.get(triangleFormat.resolve(perDrawShader), buffers[0], buffers[1]);
+    unsigned int instancedVAOs[InstanceBuffer<InstanceData>::PARTITIONS];
+    VertexFormat vertexInputs = triangleFormat.resolve(instancedShader);
+    VertexFormat instanceInputs = instanceFormat.resolve(instancedShader);
+    for (int partition = 0; partition < InstanceBuffer<InstanceData>::PARTITIONS; partition++) {
+        size_t offset = partition * instances.getStream().getPartitionSize();
+        instancedVAOs[partition] = vertexArrays.get({{vertexInputs, buffers[0], 0},
+                                                     {instanceInputs, instances.getID(), offset}}, buffers[1]);
+    }
+
+    GPUTimer gpu;
+    Timing perDraw, instanced;
+    for (int frame = 0; frame < frames; frame++) {
+        // Per object: its own slot in the uniform array, a range bind and a draw each
+        glClear(GL_COLOR_BUFFER_BIT);
+        glFinish();
+        gpu.begin();
+        auto start = std::chrono::steady_clock::now();
+        objectUniforms.clear();
+        for (size_t i = 0; i < count; i++) {
+            ObjectData object{};
+            gridPosition(i, count, object.offset.x, object.offset.y);
+            objectUniforms.push(object);
+        }
+        objectUniforms.upload();
+        perDrawShader.use();
+        GLState::bindVertexArray(perDrawVAO);
+        for (size_t i = 0; i < count; i++) {
+            objectUniforms.bind(i);
+            glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, nullptr);
+        }
+        double submit = since(start);
+        double gpuTime = gpu.end();
+        glFinish();
+        perDraw.keepBest(submit, since(start), gpuTime);
+
+        // Instanced: the same data streamed into the instance ring, one draw
+        glClear(GL_COLOR_BUFFER_BIT);
+        glFinish();
+        gpu.begin();
+        start = std::chrono::steady_clock::now();
+        instances.clear();
+        for (size_t i = 0; i < count; i++) {
+            InstanceData instance = {{0.0f, 0.0f}, 1.0f, {1.0f, 1.0f, 1.0f}};
+            gridPosition(i, count, instance.offset[0], instance.offset[1]);
+            instances.push(instance);
+        }
+        instances.upload();
+        instancedShader.use();
+        GLState::bindVertexArray(instancedVAOs[instances.getPartition()]);
+        glDrawElementsInstanced(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, nullptr, (GLsizei)instances.size());
+        instances.fence();
+        submit = since(start);
+        gpuTime = gpu.end();
+        glFinish();
+        instanced.keepBest(submit, since(start), gpuTime);
+    }
+
+    std::cout << count << " copies, best of " << frames << " frames" << std::endl;
+    std::cout << "per draw  | " << count << " draws | submit " << perDraw.submitMilliseconds << " ms, frame "
+              << perDraw.frameMilliseconds << " ms, GPU " << perDraw.gpuMilliseconds << " ms" << std::endl;
+    std::cout << "instanced | 1 draw | submit " << instanced.submitMilliseconds << " ms, frame "
+              << instanced.frameMilliseconds << " ms, GPU " << instanced.gpuMilliseconds << " ms" << std::endl;
+    std::cout << "speedup x" << perDraw.frameMilliseconds / instanced.frameMilliseconds << std::endl;
+
+    glDeleteBuffers(2, buffers);
+    GLState::forgetBuffer(buffers[0]);
+    GLState::forgetBuffer(buffers[1]);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t count = 100000;
+    if (argc > 1) count = (size_t)std::max(1, std::atoi(argv[1]));
+
+    GLBenchmark context(256, 256);
+    if (!context.isOpen()) return 1;
+    return run(count); // Everything holding GL objects lives in run, gone before the context
+}
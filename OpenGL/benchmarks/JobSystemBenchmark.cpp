@@ -0,0 +1,97 @@
+// Scaling of the job system over 1..N threads, no GL or window needed. Run with an optional thread count to stop at,
+// it goes up to std::thread::hardware_concurrency otherwise
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../core/JobSystem.h"
+
+static const int repetitions = 5; // Best of, the first runs warm up caches and wake the workers
+
+// Some math per element so the loop is bound by compute, not memory bandwidth
+static float work(float value) {
+    for (int i = 0; i < 64; i++) value = std::sqrt(value * 1.0001f + 1.0f);
+    return value;
+}
+
+// Flat loop: one parallelFor over a big array, split up front
+static double benchmarkParallelFor(JobSystem &jobs, std::vector<float> &data, size_t grain) {
+    double best = 1e30;
+    for (int run = 0; run < repetitions; run++) {
+        auto start = std::chrono::steady_clock::now();
+        jobs.parallelFor(0, data.size(), grain, [&data](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) data[i] = work(data[i]);
+        });
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// Fan out: every job spawns a few children and waits for them, only the root starts on the creating thread so the
+// rest of the tree has to be stolen. Leaves do a bit of work
+static void fanOut(JobSystem &jobs, int depth, std::vector<float> &leaves, size_t leaf) {
+    const int branches = 4;
+    if (depth == 0) {
+        float value = (float)leaf;
+        for (int i = 0; i < 32; i++) value = work(value);
+        leaves[leaf] = value;
+        return;
+    }
+
+    JobCounter children;
+    for (int branch = 0; branch < branches; branch++) {
+        jobs.run([&jobs, depth, &leaves, leaf, branch] {
+            fanOut(jobs, depth - 1, leaves, leaf * branches + branch);
+        }, &children);
+    }
+    jobs.wait(children);
+}
+
+static double benchmarkFanOut(JobSystem &jobs, std::vector<float> &leaves, int depth) {
+    double best = 1e30;
+    for (int run = 0; run < repetitions; run++) {
+        auto start = std::chrono::steady_clock::now();
+        JobCounter root;
+        jobs.run([&jobs, &leaves, depth] { fanOut(jobs, depth, leaves, 0); }, &root);
+        jobs.wait(root);
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+    if (argc > 1) maxThreads = (unsigned int)std::max(1, std::atoi(argv[1]));
+
+    const size_t elements = 1 << 20;
+    const size_t grain = 4096;
+    const int depth = 7; // 4^7 = 16384 leaves, 21845 jobs
+    std::vector<float> data(elements, 1.0f);
+    std::vector<float> leaves((size_t)1 << (2 * depth), 0.0f);
+
+    std::cout << "threads | parallelFor ms  speedup | fan out ms  speedup" << std::endl;
+    double loopBase = 0.0, fanOutBase = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+        JobSystem jobs(threads - 1); // The creating thread is one of them
+        double loop = benchmarkParallelFor(jobs, data, grain);
+        double tree = benchmarkFanOut(jobs, leaves, depth);
+        if (threads == 1) {
+            loopBase = loop;
+            fanOutBase = tree;
+        }
+        std::cout << threads << " | " << loop << " ms x" << loopBase / loop << " | " << tree << " ms x"
+                  << fanOutBase / tree << std::endl;
+    }
+
+    // Keeps the work from being optimized away
+    float checksum = 0.0f;
+    for (size_t i = 0; i < data.size(); i += 4096) checksum += data[i];
+    for (float leaf : leaves) checksum += leaf;
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
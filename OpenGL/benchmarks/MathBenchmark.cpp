@@ -0,0 +1,128 @@
+// SIMD against scalar for the math headers: mat4 x mat4, mat4 x vec4 and inverse one at a time, then the batched
+// kernels. No GL or window needed. Which SIMD path gets measured depends on the flags it's built with, SSE by default
+// on x86-64, AVX for the batches with -mavx. Run with an optional element count
+//
+// The scalar loops are plain C++, the compiler may still vectorize some of them on its own. That's what the scalar
+// path really costs so it's left alone
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../math/Batch.h"
+#include "../math/Quaternion.h"
+
+static const int repetitions = 5; // Best of, the first run warms up the caches
+
+template<typename Work>
+static double best(Work work) {
+    double fastest = 1e30;
+    for (int run = 0; run < repetitions; run++) {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        fastest = std::min(fastest, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return fastest;
+}
+
+// Largest difference between the two results, the SIMD paths round differently but shouldn't be far off
+static float difference(const std::vector<mat4> &a, const std::vector<mat4> &b) {
+    float largest = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) largest = std::max(largest, std::fabs(a[i][column][row] - b[i][column][row]));
+        }
+    }
+    return largest;
+}
+
+static float difference(const std::vector<vec4> &a, const std::vector<vec4> &b) {
+    float largest = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (int row = 0; row < 4; row++) largest = std::max(largest, std::fabs(a[i][row] - b[i][row]));
+    }
+    return largest;
+}
+
+static float difference(const std::vector<float> &a, const std::vector<float> &b) {
+    float largest = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) largest = std::max(largest, std::fabs(a[i] - b[i]));
+    return largest;
+}
+
+static void report(const char* name, double scalar, double simd, float difference) {
+    std::cout << name << " | " << scalar << " | " << simd << " | x" << scalar / simd << " | " << difference << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t count = 1 << 18;
+    if (argc > 1) count = (size_t)std::max(1, std::atoi(argv[1]));
+
+    // Model matrices like a scene has: rotation, scale and translation, always invertible
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<mat4> matrices(count);
+    std::vector<vec4> vectors(count);
+    for (size_t i = 0; i < count; i++) {
+        quat rotation = normalize(quat(unit(random), unit(random), unit(random), 1.0f));
+        matrices[i] = mat4::translate(vec3(unit(random), unit(random), unit(random)) * 100.0f) * toMat4(rotation) *
+                      mat4::scale(vec3(1.5f + unit(random), 1.5f + unit(random), 1.5f + unit(random)));
+        vectors[i] = vec4(unit(random), unit(random), unit(random), 1.0f);
+    }
+    const mat4 viewProjection = mat4::perspective(0.8f, 16.0f / 9.0f, 0.1f, 1000.0f) *
+                                mat4::lookAt(vec3(0.0f, 5.0f, 20.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    std::cout << count << " elements, best of " << repetitions << ", SSE " << MATH_SSE << ", AVX " << MATH_AVX
+              << std::endl;
+    std::cout << "operation | scalar ms | SIMD ms | speedup | max difference" << std::endl;
+
+    // Each element against its neighbour so nothing can be hoisted out of the loop
+    std::vector<mat4> scalarMatrices(count), simdMatrices(count);
+    double scalar = best([&] {
+        for (size_t i = 0; i < count; i++) scalarMatrices[i] = mulScalar(matrices[i], matrices[(i + 1) % count]);
+    });
+    double simd = best([&] {
+        for (size_t i = 0; i < count; i++) simdMatrices[i] = matrices[i] * matrices[(i + 1) % count];
+    });
+    report("mat4 x mat4", scalar, simd, difference(scalarMatrices, simdMatrices));
+
+    std::vector<vec4> scalarVectors(count), simdVectors(count);
+    scalar = best([&] {
+        for (size_t i = 0; i < count; i++) scalarVectors[i] = mulScalar(matrices[i], vectors[i]);
+    });
+    simd = best([&] {
+        for (size_t i = 0; i < count; i++) simdVectors[i] = matrices[i] * vectors[i];
+    });
+    report("mat4 x vec4", scalar, simd, difference(scalarVectors, simdVectors));
+
+    scalar = best([&] {
+        for (size_t i = 0; i < count; i++) scalarMatrices[i] = inverseScalar(matrices[i]);
+    });
+    simd = best([&] {
+        for (size_t i = 0; i < count; i++) simdMatrices[i] = inverse(matrices[i]);
+    });
+    report("inverse", scalar, simd, difference(scalarMatrices, simdMatrices));
+
+    // The batches: one view projection times every model matrix, and points through one matrix
+    scalar = best([&] { multiplyMatricesScalar(viewProjection, matrices.data(), scalarMatrices.data(), count); });
+    simd = best([&] { multiplyMatrices(viewProjection, matrices.data(), simdMatrices.data(), count); });
+    report("batch mat4 x mat4", scalar, simd, difference(scalarMatrices, simdMatrices));
+
+    std::vector<float> points(count * 3), scalarPoints(count * 3), simdPoints(count * 3);
+    for (float &coordinate : points) coordinate = unit(random) * 10.0f;
+    ConstPointsSoA in = {points.data(), points.data() + count, points.data() + 2 * count};
+    PointsSoA scalarOut = {scalarPoints.data(), scalarPoints.data() + count, scalarPoints.data() + 2 * count};
+    PointsSoA simdOut = {simdPoints.data(), simdPoints.data() + count, simdPoints.data() + 2 * count};
+    scalar = best([&] { transformPointsScalar(matrices[0], in, scalarOut, count); });
+    simd = best([&] { transformPoints(matrices[0], in, simdOut, count); });
+    report("batch points", scalar, simd, difference(scalarPoints, simdPoints));
+
+    // So the results count for something
+    float checksum = 0.0f;
+    for (size_t i = 0; i < count; i++) checksum += simdMatrices[i][3][0] + simdVectors[i].x + simdPoints[i];
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
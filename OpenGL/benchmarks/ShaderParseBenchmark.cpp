@@ -0,0 +1,104 @@
+// The mapped .shader parser against the ifstream + stringstream one it replaced, on generated vertex + fragment
+// files from 64 KB to 16 MB. Only parses, no GL calls. Run with an optional directory for the generated files, the
+// working directory otherwise
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../primitives/Shader.h"
+
+static const int repetitions = 5; // Best of, the first run also pulls the file into the page cache
+
+// The old Shader::parseShader, as it was before the mapping
+struct LegacySource {
+    std::string vertex;
+    std::string fragment;
+};
+
+static LegacySource legacyParse(const char* shaderPath) {
+    enum class ShaderType { NONE = -1, VERTEX = 0, FRAGMENT = 1 };
+    std::ifstream stream(shaderPath);
+
+    ShaderType type = ShaderType::NONE;
+
+    std::string line;
+    std::stringstream ss[2];
+
+    while (getline(stream, line)) {
+        if (line.find("#shader") != std::string::npos) {
+            if (line.find("vertex") != std::string::npos) {
+                type = ShaderType::VERTEX;
+            } else if (line.find("fragment") != std::string::npos) {
+                type = ShaderType::FRAGMENT;
+            }
+        } else {
+            ss[(int)type] << line << "\n";
+        }
+    }
+
+    return {ss[(int)ShaderType::VERTEX].str(), ss[(int)ShaderType::FRAGMENT].str()};
+}
+
+// Two stages of about size / 2 bytes each, lines that look like real GLSL
+static void writeShader(const std::string &path, size_t size) {
+    std::ofstream file(path, std::ios::binary);
+    const char* stages[2] = {"vertex", "fragment"};
+    for (const char* stage : stages) {
+        file << "#shader " << stage << "\n#version 330 core\n";
+        size_t written = 0;
+        for (int line = 0; written < size / 2; line++) {
+            std::string text = "    vec4 value" + std::to_string(line) + " = vec4(0.25, 0.5, 0.75, 1.0) * float(" +
+                               std::to_string(line) + "); // Padding to look like a real line\n";
+            file << text;
+            written += text.size();
+        }
+        file << "void main() {}\n";
+    }
+}
+
+template<typename Parse>
+static double best(Parse parse) {
+    double best = 1e30;
+    for (int run = 0; run < repetitions; run++) {
+        auto start = std::chrono::steady_clock::now();
+        parse();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::string directory = argc > 1 ? std::string(argv[1]) + "/" : "";
+    const size_t sizes[] = {64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+
+    std::cout << "file KB | ifstream ms | mapped ms  speedup | copied ms  speedup" << std::endl;
+    size_t checksum = 0; // Keeps the parses from being optimized away
+    for (size_t size : sizes) {
+        std::string path = directory + "ShaderParseBenchmark" + std::to_string(size / 1024) + ".shader";
+        writeShader(path, size);
+
+        double legacy = best([&] {
+            LegacySource source = legacyParse(path.c_str());
+            checksum += source.vertex.size() + source.fragment.size();
+        });
+        double mapped = best([&] {
+            Shader::ShaderSourceCode source = Shader::parseShader(path.c_str());
+            checksum += source.stages.size();
+        });
+        double copied = best([&] {
+            Shader::ShaderSourceCode source = Shader::parseShader(path.c_str(), {}, true);
+            checksum += source.stages.size();
+        });
+
+        std::cout << size / 1024 << " | " << legacy << " ms | " << mapped << " ms x" << legacy / mapped << " | "
+                  << copied << " ms x" << legacy / copied << std::endl;
+        std::remove(path.c_str());
+    }
+
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
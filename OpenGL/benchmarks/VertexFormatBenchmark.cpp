@@ -0,0 +1,136 @@
+// The same mesh (a grid of about 1M vertices with positions, normals and colors) in three vertex formats: all floats,
+// half floats with 8 bit colors, and half positions with 2_10_10_10 normals. Reports the bytes a vertex takes, the
+// load time conversion and the GPU time to draw it, where the smaller fetches should show. Opens a hidden window,
+// needs GL 3.3. Run with an optional grid side
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "GLBenchmark.h"
+#include "../primitives/GLState.h"
+#include "../primitives/Shader.h"
+#include "../primitives/VertexArrayCache.h"
+#include "../primitives/VertexFormat.h"
+
+static const int repetitions = 5; // Best of
+static const int drawsPerRun = 10; // One draw is too short for the timer to mean much
+
+struct Candidate {
+    const char* name;
+    VertexFormat format;
+    bool packedNormal = false; // Takes xyzw for the normal instead of xyz
+};
+
+// Plain float source data in the order pack wants it: position, normal (w too when packed), color
+static std::vector<float> source(unsigned int side, bool packedNormal) {
+    std::vector<float> data;
+    for (unsigned int row = 0; row < side; row++) {
+        for (unsigned int column = 0; column < side; column++) {
+            float x = -1.0f + 2.0f * (float)column / (float)(side - 1);
+            float y = -1.0f + 2.0f * (float)row / (float)(side - 1);
+            float nx = 0.3f * std::sin(x * 7.0f), ny = 0.3f * std::cos(y * 5.0f);
+            float nz = std::sqrt(1.0f - nx * nx - ny * ny);
+            data.insert(data.end(), {x, y, 0.0f, nx, ny, nz});
+            if (packedNormal) data.push_back(0.0f);
+            data.insert(data.end(), {0.5f + 0.5f * x, 0.5f + 0.5f * y, 0.5f});
+        }
+    }
+    return data;
+}
+
+static int run(unsigned int side) {
+    std::vector<Candidate> candidates(3);
+    candidates[0].name = "float";
+    candidates[0].format.add("aPos", 3).add("aNormal", 3).add("aColor", 3);
+    candidates[1].name = "half + unorm8";
+    candidates[1].format.add("aPos", 3, GL_HALF_FLOAT).add("aNormal", 3, GL_HALF_FLOAT)
+            .add("aColor", 3, GL_UNSIGNED_BYTE, true);
+    candidates[2].name = "half + 2_10_10_10 + unorm8";
+    candidates[2].format.add("aPos", 3, GL_HALF_FLOAT).add("aNormal", 4, GL_INT_2_10_10_10_REV, true)
+            .add("aColor", 3, GL_UNSIGNED_BYTE, true);
+    candidates[2].packedNormal = true;
+
+    // Two triangles per grid cell, each well under a pixel at this size so the raster side stays cheap
+    std::vector<unsigned int> indices;
+    for (unsigned int row = 0; row + 1 < side; row++) {
+        for (unsigned int column = 0; column + 1 < side; column++) {
+            unsigned int corner = row * side + column;
+            indices.insert(indices.end(), {corner, corner + 1, corner + side, corner + 1, corner + side + 1, corner + side});
+        }
+    }
+
+    Shader shader(GLBenchmark::shaderPath("VertexFormats.shader").c_str());
+    if (!shader.isReady()) {
+        std::cout << "ERROR::BENCHMARK::SHADERS didn't build" << std::endl;
+        return 1;
+    }
+
+    unsigned int indexBuffer;
+    glGenBuffers(1, &indexBuffer);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(indices.size() * sizeof(unsigned int)), indices.data(),
+                 GL_STATIC_DRAW);
+
+    VertexArrayCache vertexArrays;
+    GPUTimer gpu;
+    size_t vertexCount = (size_t)side * side;
+    std::cout << vertexCount << " vertices, " << indices.size() / 3 << " triangles, best of " << repetitions << std::endl;
+    std::cout << "format | bytes per vertex | buffer MB | pack ms | GPU ms per draw" << std::endl;
+    double floatTime = 0.0;
+    std::vector<unsigned int> vertexBuffers; // Kept until the end, the cache holds on to their VAOs
+    for (Candidate &candidate : candidates) {
+        std::vector<float> floats = source(side, candidate.packedNormal);
+
+        double pack = 1e30;
+        std::vector<unsigned char> packed;
+        for (int run = 0; run < repetitions; run++) {
+            auto start = std::chrono::steady_clock::now();
+            packed = candidate.format.pack(floats.data(), vertexCount);
+            pack = std::min(pack, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        unsigned int vertexBuffer;
+        glGenBuffers(1, &vertexBuffer);
+        vertexBuffers.push_back(vertexBuffer);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)packed.size(), packed.data(), GL_STATIC_DRAW);
+        unsigned int vertexArray = vertexArrays.get(candidate.format.resolve(shader), vertexBuffer, indexBuffer);
+
+        shader.use();
+        GLState::bindVertexArray(vertexArray);
+        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr); // Warm up
+        glFinish();
+
+        double draw = 1e30;
+        for (int run = 0; run < repetitions; run++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            gpu.begin();
+            for (int i = 0; i < drawsPerRun; i++) {
+                glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr);
+            }
+            draw = std::min(draw, gpu.end() / drawsPerRun);
+        }
+        if (floatTime == 0.0) floatTime = draw;
+
+        std::cout << candidate.name << " | " << candidate.format.getStride() << " | "
+                  << (double)packed.size() / (1024.0 * 1024.0) << " | " << pack << " | " << draw << " x"
+                  << floatTime / draw << std::endl;
+    }
+
+    vertexBuffers.push_back(indexBuffer);
+    glDeleteBuffers((GLsizei)vertexBuffers.size(), vertexBuffers.data());
+    for (unsigned int buffer : vertexBuffers) GLState::forgetBuffer(buffer);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned int side = 1024;
+    if (argc > 1) side = (unsigned int)std::max(2, std::atoi(argv[1]));
+
+    GLBenchmark context(256, 256);
+    if (!context.isOpen()) return 1;
+    return run(side); // Everything holding GL objects lives in run, gone before the context
+}
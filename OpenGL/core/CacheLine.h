@@ -0,0 +1,18 @@
+#ifndef LEARNOPENGL_CACHELINE_H
+#define LEARNOPENGL_CACHELINE_H
+
+#include <cstddef>
+
+// Cache line size on everything we run on
+const size_t CACHE_LINE = 64;
+
+// Goes between members that different threads write, so they don't share a cache line and keep stealing it from each
+// other. used is how much of the line the member before it already takes. This is padding rather than alignas(64):
+// the structs using it live on the heap (new, std::vector) and those only honour extended alignment from C++17 on
+template<size_t used = 0>
+struct CachePadding {
+    static_assert(used < CACHE_LINE, "The member already fills the cache line");
+    char bytes[CACHE_LINE - used];
+};
+
+#endif //LEARNOPENGL_CACHELINE_H
@@ -0,0 +1,96 @@
+#include "FrameClock.h"
+#include <algorithm>
+#include <cmath>
+
+// Weight of the newest frame in the smoothed frame time, about the last 10 frames count
+static const double smoothing = 0.1;
+
+FrameClock::FrameClock(double fixedStep, unsigned int maxSteps, size_t history)
+        : fixedStep(fixedStep), maxSteps(maxSteps), history(std::max(history, (size_t)1)) {
+    frameTimes.reserve(this->history);
+    sorted.reserve(this->history);
+}
+
+unsigned int FrameClock::tick(double now, bool resumed) {
+    if (frames++ == 0) {
+        // Nothing to measure yet, the simulation starts here
+        lastTime = now;
+        simulationTime = now;
+        return 0;
+    }
+
+    if (resumed) {
+        lastTime = now;
+        delta = 0.0;
+        return 0;
+    }
+
+    delta = std::max(now - lastTime, 0.0);
+    lastTime = now;
+    // Seeded by the first measured frame, which is not always the second one
+    smoothedDelta = smoothedDelta == 0.0 ? delta : smoothedDelta + (delta - smoothedDelta) * smoothing;
+
+    auto milliseconds = (float)(delta * 1000.0);
+    if (frameTimes.size() < history) {
+        frameTimes.push_back(milliseconds);
+    } else {
+        frameTimes[nextFrameTime] = milliseconds;
+        nextFrameTime = (nextFrameTime + 1) % history;
+    }
+
+    accumulator += delta;
+    unsigned int steps = 0;
+    while (accumulator >= fixedStep && steps < maxSteps) {
+        accumulator -= fixedStep;
+        simulationTime += fixedStep;
+        steps++;
+    }
+    if (accumulator >= fixedStep) {
+        // Stalled, the simulation just falls behind by whole steps instead of spiraling
+        accumulator -= std::floor(accumulator / fixedStep) * fixedStep;
+    }
+    return steps;
+}
+
+double FrameClock::getFixedStep() const {
+    return fixedStep;
+}
+
+double FrameClock::getSimulationTime() const {
+    return simulationTime;
+}
+
+float FrameClock::getAlpha() const {
+    return (float)(accumulator / fixedStep);
+}
+
+double FrameClock::getRenderTime() const {
+    return simulationTime - fixedStep + accumulator;
+}
+
+double FrameClock::getDelta() const {
+    return delta;
+}
+
+double FrameClock::getSmoothedDelta() const {
+    return smoothedDelta;
+}
+
+FrameClock::Percentiles FrameClock::getPercentiles() const {
+    if (frameTimes.empty()) return {0.0f, 0.0f, 0.0f};
+
+    // Nearest rank, each one only sorts the part above the last
+    sorted.assign(frameTimes.begin(), frameTimes.end());
+    auto rank = [this](float percentile) {
+        return std::min(sorted.size() - 1, (size_t)(percentile * (float)sorted.size()));
+    };
+    size_t p50 = rank(0.50f), p95 = rank(0.95f), p99 = rank(0.99f);
+    std::nth_element(sorted.begin(), sorted.begin() + p50, sorted.end());
+    if (p95 > p50) std::nth_element(sorted.begin() + p50 + 1, sorted.begin() + p95, sorted.end());
+    if (p99 > p95) std::nth_element(sorted.begin() + p95 + 1, sorted.begin() + p99, sorted.end());
+    return {sorted[p50], sorted[p95], sorted[p99]};
+}
+
+unsigned long long FrameClock::getFrameCount() const {
+    return frames;
+}
@@ -0,0 +1,80 @@
+#ifndef LEARNOPENGL_FRAMECLOCK_H
+#define LEARNOPENGL_FRAMECLOCK_H
+
+#include <cstddef>
+#include <vector>
+
+// Frame timing. The simulation advances in fixed steps no matter how long frames take, so animation comes out the
+// same under load; rendering then draws between the last two steps using getAlpha. It also keeps a smoothed frame time
+// and the frame times of the last few seconds for percentiles.
+class FrameClock {
+public:
+    struct Percentiles {
+        float p50; // Milliseconds
+        float p95;
+        float p99;
+    };
+
+    // After a long stall at most maxSteps are run and the rest of the time is dropped, catching up would only make
+    // the next frame slower too. history is how many frame times the percentiles cover, at least 1
+    explicit FrameClock(double fixedStep = 1.0 / 120.0, unsigned int maxSteps = 8, size_t history = 512);
+
+    // Once a frame with the time the frame is for, one sample only so everything in the frame agrees. Returns how
+    // many fixed steps to simulate. resumed says the loop slept since the last tick (idle on demand): that gap isn't
+    // a frame, it stays out of the frame times and the smoothing and the simulation doesn't catch up on it
+    unsigned int tick(double now, bool resumed = false);
+
+    double getFixedStep() const;
+
+    // Time of the most recent step, what the simulation has reached
+    double getSimulationTime() const;
+
+    // How far the frame is between the previous step and the latest one, 0..1
+    float getAlpha() const;
+
+    // Between the previous step and the latest one, what time based effects should show this frame
+    double getRenderTime() const;
+
+    // Seconds since the last tick, raw (0 after a resume) and smoothed
+    double getDelta() const;
+
+    double getSmoothedDelta() const;
+
+    // Over the last history frames
+    Percentiles getPercentiles() const;
+
+    unsigned long long getFrameCount() const;
+
+private:
+    double fixedStep;
+    unsigned int maxSteps;
+    double lastTime = 0.0;
+    double accumulator = 0.0;
+    double simulationTime = 0.0;
+    double delta = 0.0;
+    double smoothedDelta = 0.0;
+    unsigned long long frames = 0;
+
+    size_t history;
+    std::vector<float> frameTimes; // Ring of milliseconds, history long once full
+    size_t nextFrameTime = 0;
+    mutable std::vector<float> sorted; // Scratch for getPercentiles
+};
+
+// A value the simulation sets once a step and rendering blends between the last two of. Anything with + - and * float
+template<typename T>
+struct Interpolated {
+    T previous;
+    T current;
+
+    explicit Interpolated(const T &value = T()) : previous(value), current(value) {}
+
+    void step(const T &next) {
+        previous = current;
+        current = next;
+    }
+
+    T at(float alpha) const { return previous + (current - previous) * alpha; }
+};
+
+#endif //LEARNOPENGL_FRAMECLOCK_H
@@ -0,0 +1,179 @@
+#include "JobSystem.h"
+
+// Which system and deque the calling thread belongs to
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local unsigned int currentIndex = 0;
+
+JobSystem::JobSystem(unsigned int threads) {
+    if (threads == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 0;
+    }
+
+    for (unsigned int i = 0; i <= threads; i++) {
+        workers.emplace_back(new Worker());
+        workers.back()->random = i * 2654435761u + 1;
+    }
+    currentSystem = this;
+    currentIndex = 0;
+
+    for (unsigned int i = 1; i <= threads; i++) this->threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) thread.join();
+    if (currentSystem == this) currentSystem = nullptr;
+}
+
+JobSystem::Worker *JobSystem::currentWorker() const {
+    return currentSystem == this ? workers[currentIndex].get() : nullptr;
+}
+
+void JobSystem::run(std::function<void()> work, JobCounter *counter) {
+    Worker* worker = currentWorker();
+    Job* job = worker ? allocate(*worker, work, counter) : nullptr;
+    if (!job) {
+        // Not one of ours, or a few thousand jobs behind: cheaper to just do it
+        work();
+        return;
+    }
+    submit(*worker, job);
+}
+
+void JobSystem::runAfter(JobCounter &dependency, std::function<void()> work, JobCounter *counter) {
+    Worker* worker = currentWorker();
+    Job* job = worker ? allocate(*worker, work, counter) : nullptr;
+    if (!job) {
+        wait(dependency);
+        work();
+        return;
+    }
+
+    {
+        // Whoever takes the dependency to zero swaps the list out under this lock, so either it finds the job
+        // there or we see zero here
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.push_back(job);
+            return;
+        }
+    }
+    submit(*worker, job);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    Worker* worker = currentWorker();
+    while (!counter.done()) {
+        Job* job = worker ? next(*worker) : nullptr;
+        if (job) {
+            execute(job);
+        } else {
+            std::this_thread::yield(); // The rest is running elsewhere
+        }
+    }
+}
+
+unsigned int JobSystem::getThreadCount() const {
+    return (unsigned int)workers.size();
+}
+
+unsigned int JobSystem::getThreadIndex() const {
+    return currentSystem == this ? currentIndex : getThreadCount();
+}
+
+Job *JobSystem::allocate(Worker &worker, std::function<void()> &work, JobCounter *counter) {
+    Job &job = worker.jobs[worker.nextJob % JOBS_PER_THREAD];
+    if (!job.free.load(std::memory_order_acquire)) return nullptr;
+    worker.nextJob++;
+
+    job.free.store(false, std::memory_order_relaxed);
+    job.work = std::move(work);
+    job.counter = counter;
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    return &job;
+}
+
+void JobSystem::submit(Worker &worker, Job *job) {
+    if (!worker.queue.push(job)) {
+        execute(job); // Deque is full
+        return;
+    }
+
+    // Pairs with the sleeping check in workerLoop: either they see the job or we see them asleep
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+}
+
+Job *JobSystem::next(Worker &worker) {
+    Job* job = worker.queue.pop();
+    if (!job) {
+        // Someone else's oldest job, starting from a random victim so thieves spread out
+        size_t count = workers.size();
+        worker.random = worker.random * 1664525u + 1013904223u;
+        size_t start = worker.random % count;
+        for (size_t i = 0; i < count && !job; i++) {
+            Worker &victim = *workers[(start + i) % count];
+            if (&victim != &worker) job = victim.queue.steal();
+        }
+    }
+    if (job) queued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::execute(Job *job) {
+    job->work();
+    job->work = nullptr; // Drops the captures now rather than when the slot comes around again
+    JobCounter* counter = job->counter;
+    job->free.store(true, std::memory_order_release);
+    if (counter) finish(*counter);
+}
+
+void JobSystem::finish(JobCounter &counter) {
+    // A waiter can return as soon as pending is zero, finishing keeps it around while the continuations are taken
+    counter.finishing.fetch_add(1, std::memory_order_seq_cst);
+    if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::vector<Job*> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter.mutex);
+            ready.swap(counter.continuations);
+        }
+        Worker* worker = currentWorker();
+        for (Job* job : ready) {
+            if (worker) {
+                submit(*worker, job);
+            } else {
+                execute(job);
+            }
+        }
+    }
+    counter.finishing.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(unsigned int index) {
+    currentSystem = this;
+    currentIndex = index;
+    Worker &worker = *workers[index];
+
+    while (true) {
+        Job* job = next(worker);
+        if (job) {
+            execute(job);
+            continue;
+        }
+
+        // Nothing anywhere, sleep until a submit wakes us up
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return quit || queued.load(std::memory_order_seq_cst) > 0; });
+        sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        if (quit) return;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef LEARNOPENGL_JOBSYSTEM_H
+#define LEARNOPENGL_JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "WorkStealingQueue.h"
+
+// Counts the jobs started with it that haven't finished yet. Waiting on it runs other jobs in the meantime, and jobs
+// can be held back until one reaches zero. Don't start more jobs with a counter someone is still waiting on, and keep
+// it alive until the wait returns.
+struct JobCounter {
+    std::atomic<int> pending{0};
+    std::atomic<int> finishing{0}; // Threads still touching the counter after taking it to zero
+    std::mutex mutex;
+    std::vector<Job*> continuations; // Started once pending gets to zero
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0 &&
+                               finishing.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job {
+    std::function<void()> work;
+    JobCounter* counter = nullptr;
+    std::atomic<bool> free{true}; // The slot can be reused
+};
+
+// Work stealing job system. Every worker, and the thread that created the system, has its own deque of jobs: new jobs
+// go to the bottom of the caller's deque, idle threads steal from the top of someone else's. Only those threads
+// can queue jobs, anything started from another thread just runs right away on it.
+class JobSystem {
+public:
+    // Threads 0 picks one less than the hardware has, the creating thread makes up the difference
+    explicit JobSystem(unsigned int threads = 0);
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void run(std::function<void()> work, JobCounter* counter = nullptr);
+
+    // Queued once dependency gets to zero
+    void runAfter(JobCounter &dependency, std::function<void()> work, JobCounter* counter = nullptr);
+
+    // Runs jobs, this thread's first, until the counter gets to zero
+    void wait(JobCounter &counter);
+
+    // Splits [begin, end) into chunks of at most grain and calls body(first, last) for each one in parallel. Returns
+    // when all of them are done
+    template<typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Body &body) {
+        if (grain == 0) grain = 1;
+        JobCounter counter;
+        for (size_t first = begin; first < end; first += grain) {
+            size_t last = end - first > grain ? first + grain : end;
+            run([&body, first, last] { body(first, last); }, &counter);
+        }
+        wait(counter);
+    }
+
+    // Workers plus the creating thread
+    unsigned int getThreadCount() const;
+
+    // 0 for the creating thread, 1 up for workers, so per thread data can be kept in an array. Other threads get
+    // getThreadCount(), size such arrays getThreadCount() + 1 if jobs can be started from outside
+    unsigned int getThreadIndex() const;
+
+private:
+    static const unsigned int JOBS_PER_THREAD = (unsigned int)WorkStealingQueue::CAPACITY;
+
+    struct Worker {
+        WorkStealingQueue queue;
+        std::unique_ptr<Job[]> jobs{new Job[JOBS_PER_THREAD]}; // Ring, slots come back when their job is done
+        unsigned int nextJob = 0;
+        unsigned int random = 0; // Picks whom to steal from
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers; // 0 belongs to the creating thread
+    std::vector<std::thread> threads;
+
+    // Idle workers sleep until something is queued
+    std::atomic<int> queued{0};
+    std::atomic<int> sleeping{0};
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit = false;
+
+    Worker* currentWorker() const;
+
+    Job* allocate(Worker &worker, std::function<void()> &work, JobCounter* counter);
+
+    void submit(Worker &worker, Job* job);
+
+    Job* next(Worker &worker);
+
+    void execute(Job* job);
+
+    void finish(JobCounter &counter);
+
+    void workerLoop(unsigned int index);
+};
+
+#endif //LEARNOPENGL_JOBSYSTEM_H
@@ -0,0 +1,97 @@
+#include "RedrawScheduler.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Otherwise its min/max macros break std::max
+#endif
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+RedrawScheduler::RedrawScheduler(bool onDemand) : onDemand(onDemand) {}
+
+void RedrawScheduler::setWake(std::function<void()> wake) {
+    this->wake = std::move(wake);
+}
+
+void RedrawScheduler::setOnDemand(bool onDemand) {
+    this->onDemand = onDemand;
+    requestRedraw();
+}
+
+bool RedrawScheduler::isOnDemand() const {
+    return onDemand;
+}
+
+void RedrawScheduler::requestRedraw() {
+    // Only the first request since the last frame has to wake anyone
+    if (!dirty.exchange(true) && wake) wake();
+}
+
+void RedrawScheduler::startAnimation() {
+    if (animations.fetch_add(1) == 0 && wake) wake();
+}
+
+void RedrawScheduler::stopAnimation() {
+    animations.fetch_sub(1);
+}
+
+bool RedrawScheduler::isAnimating() const {
+    return animations.load() > 0;
+}
+
+bool RedrawScheduler::hasWork() const {
+    return !onDemand || animations.load() > 0 || dirty.load();
+}
+
+bool RedrawScheduler::takeFrame() {
+    bool requested = dirty.exchange(false);
+    bool draw = requested || !onDemand || animations.load() > 0;
+
+    if (draw && idleTime > 0.0) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.idleCpuPercent = (float)(idleCpu / idleTime * 100.0);
+        stats.idleSeconds = idleTime;
+        idleCpu = 0.0;
+        idleTime = 0.0;
+    }
+    return draw;
+}
+
+void RedrawScheduler::beginIdle(double now) {
+    idleStartCpu = processCpuSeconds();
+    idleStartTime = now;
+}
+
+void RedrawScheduler::endIdle(double now) {
+    idleCpu += processCpuSeconds() - idleStartCpu;
+    idleTime += now - idleStartTime;
+}
+
+void RedrawScheduler::recordWake(double milliseconds) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.wakeMilliseconds = milliseconds;
+    stats.maxWakeMilliseconds = std::max(stats.maxWakeMilliseconds, milliseconds);
+}
+
+RedrawScheduler::Stats RedrawScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+double RedrawScheduler::processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    auto hundredNanoseconds = [](const FILETIME &time) {
+        return (double)(((unsigned long long)time.dwHighDateTime << 32) | time.dwLowDateTime);
+    };
+    return (hundredNanoseconds(kernel) + hundredNanoseconds(user)) * 1e-7;
+#else
+    timespec time{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) return 0.0;
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
@@ -0,0 +1,76 @@
+#ifndef LEARNOPENGL_REDRAWSCHEDULER_H
+#define LEARNOPENGL_REDRAWSCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+// Decides when a frame is worth drawing. In on demand mode nothing is drawn unless something asked for it: a one off
+// change calls requestRedraw, anything that moves every frame holds an animation for as long as it runs. With
+// neither, the loop sleeps in the event queue until input or a request wakes it up. It also measures what that buys:
+// process CPU use while idle, and how long a wake up takes to reach the screen.
+class RedrawScheduler {
+public:
+    struct Stats {
+        float idleCpuPercent; // Whole process CPU time over wall time during the last idle stretch, 100 is one core
+        double idleSeconds; // How long that stretch was
+        double wakeMilliseconds; // From the loop waking up to the frame it caused being swapped, last wake up
+        double maxWakeMilliseconds;
+    };
+
+    explicit RedrawScheduler(bool onDemand = true);
+
+    // How to get the waiting loop out of its wait from another thread, glfwPostEmptyEvent. Set before sharing it
+    void setWake(std::function<void()> wake);
+
+    // Off draws every frame like before
+    void setOnDemand(bool onDemand);
+
+    bool isOnDemand() const;
+
+    // Any thread. Draws one more frame
+    void requestRedraw();
+
+    // Any thread. Frames keep coming while at least one animation runs
+    void startAnimation();
+
+    void stopAnimation();
+
+    bool isAnimating() const;
+
+    // Loop thread. False when it can go idle
+    bool hasWork() const;
+
+    // Loop thread, when about to send a frame. True if it should be drawn, takes the redraw request
+    bool takeFrame();
+
+    // Loop thread, around its idle waits. Seconds from the same clock as the wake up times
+    void beginIdle(double now);
+
+    void endIdle(double now);
+
+    // Render thread, once the frame a wake up caused has been swapped
+    void recordWake(double milliseconds);
+
+    Stats getStats() const;
+
+    // CPU time used by every thread of the process so far
+    static double processCpuSeconds();
+
+private:
+    std::atomic<bool> onDemand;
+    std::atomic<bool> dirty{true}; // The first frame always draws
+    std::atomic<int> animations{0};
+    std::function<void()> wake;
+
+    // Idle stretch being measured, loop thread only. Several waits in a row (timeouts) add up until a frame is drawn
+    double idleStartCpu = 0.0;
+    double idleStartTime = 0.0;
+    double idleCpu = 0.0;
+    double idleTime = 0.0;
+
+    mutable std::mutex statsMutex;
+    Stats stats = {0.0f, 0.0, 0.0, 0.0};
+};
+
+#endif //LEARNOPENGL_REDRAWSCHEDULER_H
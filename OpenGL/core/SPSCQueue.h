@@ -0,0 +1,66 @@
+#ifndef LEARNOPENGL_SPSCQUEUE_H
+#define LEARNOPENGL_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include "CacheLine.h"
+
+// Fixed size queue between exactly one producer thread and one consumer thread, no locks. Each side owns one index
+// and keeps a stale copy of the other one, so it only reads the other side's cache line when the copy says the
+// queue looks full (or empty). Neither side ever waits, push and pop just fail and the caller decides how to wait.
+template<typename T, size_t CAPACITY>
+class SPSCQueue {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SPSCQueue capacity has to be a power of two");
+
+public:
+    // Producer only
+    bool push(T value) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead == CAPACITY) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (tail - cachedHead == CAPACITY) return false;
+        }
+        slots[tail & (CAPACITY - 1)] = std::move(value);
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool pop(T &value) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (head == cachedTail) return false;
+        }
+        value = std::move(slots[head & (CAPACITY - 1)]);
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer only
+    bool full() {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead < CAPACITY) return false;
+        cachedHead = head.load(std::memory_order_acquire);
+        return tail - cachedHead == CAPACITY;
+    }
+
+private:
+    // Each side's indices on their own cache line
+    CachePadding<> leadingPadding;
+
+    // Consumer side
+    std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    CachePadding<> consumerPadding;
+
+    // Producer side
+    std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    CachePadding<> producerPadding;
+
+    T slots[CAPACITY];
+};
+
+#endif //LEARNOPENGL_SPSCQUEUE_H
@@ -0,0 +1,56 @@
+#include "WorkStealingQueue.h"
+
+WorkStealingQueue::WorkStealingQueue() : top(0), bottom(0) {
+    for (std::atomic<Job*> &job : jobs) job.store(nullptr, std::memory_order_relaxed);
+}
+
+bool WorkStealingQueue::push(Job *job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) return false;
+
+    jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    // The job has to be in the slot before a thief can see the new bottom
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+Job *WorkStealingQueue::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    // Claim the bottom slot before looking at top, thieves do it the other way around
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) { // Was empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last one, a thief could be after it too. Whoever moves top gets it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job *WorkStealingQueue::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+
+    Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr; // Another thief or the owner was faster
+    }
+    return job;
+}
+
+bool WorkStealingQueue::empty() const {
+    return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,41 @@
+#ifndef LEARNOPENGL_WORKSTEALINGQUEUE_H
+#define LEARNOPENGL_WORKSTEALINGQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include "CacheLine.h"
+
+struct Job;
+
+// Chase-Lev deque with a fixed size ring (Lê, Pop, Cohen, Zappa Nardelli 2013, minus the resizing). The owning
+// thread pushes and pops at the bottom, newest first so it stays on warm data; any other thread steals from the top,
+// oldest first, which tends to be the biggest piece of work.
+class WorkStealingQueue {
+public:
+    static const int64_t CAPACITY = 4096; // Power of two
+
+    WorkStealingQueue();
+
+    // Owner only. False when full
+    bool push(Job* job);
+
+    // Owner only. Nullptr when empty or when a thief got the last job first
+    Job* pop();
+
+    // Any thread. Nullptr when empty or when it lost the race for the top job
+    Job* steal();
+
+    // Rough, for idle checks only
+    bool empty() const;
+
+private:
+    // Own cache lines, thieves hammer top while the owner works on bottom
+    CachePadding<> leadingPadding;
+    std::atomic<int64_t> top;
+    CachePadding<sizeof(std::atomic<int64_t>)> topPadding;
+    std::atomic<int64_t> bottom;
+    CachePadding<sizeof(std::atomic<int64_t>)> bottomPadding;
+    std::atomic<Job*> jobs[CAPACITY];
+};
+
+#endif //LEARNOPENGL_WORKSTEALINGQUEUE_H
@@ -0,0 +1,303 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Forsyth's scoring, see "Linear-Speed Vertex Cache Optimisation". The cache is a bit bigger than what the hardware
+// has, the order works well for any cache up to this size
+static const int forsythCacheSize = 32;
+static const float cacheDecayPower = 1.5f;
+static const float lastTriangleScore = 0.75f;
+static const float valenceBoostScale = 2.0f;
+static const float valenceBoostPower = 0.5f;
+
+static float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) return -1.0f; // Nothing left to draw with it
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // Used by the last triangle, a fixed score so the next one doesn't just repeat the same edge
+            score = lastTriangleScore;
+        } else {
+            float scale = 1.0f / (forsythCacheSize - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, cacheDecayPower);
+        }
+    }
+
+    // Vertices with few triangles left get a boost so they are finished off and don't linger as lone triangles
+    return score + valenceBoostScale * std::pow((float)remainingTriangles, -valenceBoostPower);
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(std::vector<float> &vertices, unsigned int floatsPerVertex,
+                                              std::vector<unsigned int> &indices, bool overdraw,
+                                              unsigned int positionOffset) {
+    Report report;
+    size_t vertexCount = vertices.size() / floatsPerVertex;
+    report.before = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    std::vector<unsigned int> reordered(indices.size());
+    optimizeVertexCache(reordered.data(), indices.data(), indices.size(), vertexCount);
+
+    if (overdraw) {
+        optimizeOverdraw(indices.data(), reordered.data(), reordered.size(), vertices.data() + positionOffset,
+                         floatsPerVertex, vertexCount);
+    } else {
+        indices.swap(reordered);
+    }
+
+    std::vector<float> fetched(vertices.size());
+    report.vertexCount = optimizeVertexFetch(fetched.data(), indices.data(), indices.size(), vertices.data(),
+                                             vertexCount, floatsPerVertex * sizeof(float));
+    fetched.resize(report.vertexCount * floatsPerVertex);
+    vertices.swap(fetched);
+
+    report.after = analyzeVertexCache(indices.data(), indices.size(), report.vertexCount);
+    report.indexSize = indexSize(report.vertexCount);
+    return report;
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const unsigned int *indices, size_t indexCount,
+                                                            size_t vertexCount, unsigned int cacheSize) {
+    // Timestamp FIFO: a vertex is in the cache if it was inserted less than cacheSize misses ago
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    size_t misses = 0, usedVertices = 0;
+
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int vertex = indices[i];
+        if (!used[vertex]) {
+            used[vertex] = true;
+            usedVertices++;
+        }
+        if (insertedAt[vertex] == 0 || misses - insertedAt[vertex] >= cacheSize) {
+            misses++;
+            insertedAt[vertex] = misses;
+        }
+    }
+
+    CacheStats stats;
+    size_t triangles = indexCount / 3;
+    stats.acmr = triangles > 0 ? (float)misses / triangles : 0.0f;
+    stats.atvr = usedVertices > 0 ? (float)misses / usedVertices : 0.0f;
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(unsigned int *destination, const unsigned int *indices, size_t indexCount,
+                                        size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+
+    // Triangles using each vertex, as one flat array with offsets
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) remaining[indices[i]]++;
+
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) adjacency[fill[indices[t * 3 + corner]]++] = (unsigned int)t;
+    }
+
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) score[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    // Three extra slots, the vertices pushed out of the cache by the last triangle still need their scores updated
+    std::vector<unsigned int> cache, nextCache;
+    cache.reserve(forsythCacheSize + 3);
+    nextCache.reserve(forsythCacheSize + 3);
+
+    size_t scanCursor = 0; // Fallback when the cache holds nothing useful, first triangle not emitted yet
+    long best = triangleCount > 0 ? 0 : -1;
+    for (size_t t = 1; t < triangleCount; t++) if (triangleScore[t] > triangleScore[best]) best = (long)t;
+
+    for (size_t output = 0; output < triangleCount; output++) {
+        if (best < 0) {
+            while (scanCursor < triangleCount && emitted[scanCursor]) scanCursor++;
+            best = (long)scanCursor;
+        }
+
+        const unsigned int* triangle = indices + best * 3;
+        memcpy(destination + output * 3, triangle, 3 * sizeof(unsigned int));
+        emitted[best] = true;
+
+        // The triangle's vertices go to the front of the LRU cache, the rest keep their order behind them
+        nextCache.assign(triangle, triangle + 3);
+        for (unsigned int vertex : cache) {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) nextCache.push_back(vertex);
+        }
+        cache.swap(nextCache);
+
+        for (int corner = 0; corner < 3; corner++) {
+            unsigned int vertex = triangle[corner];
+            unsigned int* begin = &adjacency[adjacencyOffset[vertex]];
+            unsigned int* end = begin + remaining[vertex];
+            *std::find(begin, end, (unsigned int)best) = *(end - 1); // Drop it from the vertex's list
+            remaining[vertex]--;
+        }
+
+        // Rescore everything that was in the cache, including what just fell out
+        for (size_t slot = 0; slot < cache.size(); slot++) {
+            unsigned int vertex = cache[slot];
+            int position = slot < (size_t)forsythCacheSize ? (int)slot : -1;
+
+            float newScore = vertexScore(position, remaining[vertex]);
+            float delta = newScore - score[vertex];
+            score[vertex] = newScore;
+            for (unsigned int i = adjacencyOffset[vertex]; i < adjacencyOffset[vertex] + remaining[vertex]; i++) {
+                triangleScore[adjacency[i]] += delta;
+            }
+        }
+
+        // Then the next triangle is the best one touching the cache, if none does we fall back to the scan
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int vertex : cache) {
+            for (unsigned int i = adjacencyOffset[vertex]; i < adjacencyOffset[vertex] + remaining[vertex]; i++) {
+                if (triangleScore[adjacency[i]] > bestScore) {
+                    bestScore = triangleScore[adjacency[i]];
+                    best = adjacency[i];
+                }
+            }
+        }
+
+        if (cache.size() > (size_t)forsythCacheSize) cache.resize(forsythCacheSize);
+    }
+}
+
+void MeshOptimizer::optimizeOverdraw(unsigned int *destination, const unsigned int *indices, size_t indexCount,
+                                     const float *positions, size_t positionStride, size_t vertexCount,
+                                     float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    float meshACMR = analyzeVertexCache(indices, indexCount, vertexCount).acmr;
+
+    // A cluster ends as soon as its own ACMR is within threshold of the whole mesh, counted with the cache starting
+    // empty like it does once the clusters are shuffled around (Sander et al.'s soft boundaries). Cache order rarely
+    // jumps on a connected mesh, so waiting for a triangle with three misses would leave a single cluster
+    std::vector<size_t> clusterStart(1, 0);
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t misses = 0, clusterFirstMiss = 0, clusterMisses = 0, clusterTriangles = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            unsigned int vertex = indices[t * 3 + corner];
+            if (insertedAt[vertex] <= clusterFirstMiss || misses - insertedAt[vertex] >= 16) {
+                misses++;
+                insertedAt[vertex] = misses;
+                clusterMisses++;
+            }
+        }
+        clusterTriangles++;
+
+        if (t + 1 < triangleCount && (float)clusterMisses <= meshACMR * threshold * (float)clusterTriangles) {
+            clusterStart.push_back(t + 1);
+            clusterFirstMiss = misses;
+            clusterMisses = 0;
+            clusterTriangles = 0;
+        }
+    }
+    clusterStart.push_back(triangleCount);
+
+    auto position = [&](unsigned int vertex) { return positions + vertex * positionStride; };
+
+    // Centroid of the whole mesh, area weighted
+    float meshCenter[3] = {0, 0, 0};
+    float meshArea = 0.0f;
+    std::vector<float> clusterCenter((clusterStart.size() - 1) * 3, 0.0f);
+    std::vector<float> clusterNormal((clusterStart.size() - 1) * 3, 0.0f);
+    std::vector<float> clusterArea(clusterStart.size() - 1, 0.0f);
+
+    for (size_t cluster = 0; cluster + 1 < clusterStart.size(); cluster++) {
+        for (size_t t = clusterStart[cluster]; t < clusterStart[cluster + 1]; t++) {
+            const float* a = position(indices[t * 3]);
+            const float* b = position(indices[t * 3 + 1]);
+            const float* c = position(indices[t * 3 + 2]);
+
+            float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            float normal[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            for (int axis = 0; axis < 3; axis++) {
+                float center = (a[axis] + b[axis] + c[axis]) / 3.0f;
+                clusterCenter[cluster * 3 + axis] += center * area;
+                clusterNormal[cluster * 3 + axis] += normal[axis]; // Its length is the area, so this is area weighted
+                meshCenter[axis] += center * area;
+            }
+            clusterArea[cluster] += area;
+            meshArea += area;
+        }
+    }
+
+    if (meshArea > 0.0f) for (float &axis : meshCenter) axis /= meshArea;
+
+    // Clusters facing away from the center come first, they are the ones most likely to hide the rest
+    std::vector<float> sortKey(clusterArea.size());
+    std::vector<size_t> order(clusterArea.size());
+    for (size_t cluster = 0; cluster < clusterArea.size(); cluster++) {
+        float key = 0.0f;
+        if (clusterArea[cluster] > 0.0f) {
+            for (int axis = 0; axis < 3; axis++) {
+                float center = clusterCenter[cluster * 3 + axis] / clusterArea[cluster];
+                key += (center - meshCenter[axis]) * clusterNormal[cluster * 3 + axis];
+            }
+            key /= clusterArea[cluster];
+        }
+        sortKey[cluster] = key;
+        order[cluster] = cluster;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    size_t output = 0;
+    for (size_t cluster : order) {
+        size_t begin = clusterStart[cluster] * 3, end = clusterStart[cluster + 1] * 3;
+        memcpy(destination + output, indices + begin, (end - begin) * sizeof(unsigned int));
+        output += end - begin;
+    }
+}
+
+size_t MeshOptimizer::optimizeVertexFetch(void *destination, unsigned int *indices, size_t indexCount,
+                                          const void *vertices, size_t vertexCount, size_t vertexSize) {
+    const unsigned int unassigned = ~0u;
+    std::vector<unsigned int> remap(vertexCount, unassigned);
+    unsigned int next = 0;
+
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int &newIndex = remap[indices[i]];
+        if (newIndex == unassigned) {
+            newIndex = next++;
+            memcpy((char*)destination + newIndex * vertexSize, (const char*)vertices + indices[i] * vertexSize, vertexSize);
+        }
+        indices[i] = newIndex;
+    }
+
+    return next;
+}
+
+unsigned int MeshOptimizer::indexSize(size_t vertexCount) {
+    // 0xFFFF is left out, it is the primitive restart index when that is enabled
+    return vertexCount < 0xFFFF ? 2 : 4;
+}
+
+std::vector<unsigned char> MeshOptimizer::packIndices(const unsigned int *indices, size_t indexCount,
+                                                      unsigned int indexSize) {
+    std::vector<unsigned char> packed(indexCount * indexSize);
+    if (indexSize == 4) {
+        memcpy(packed.data(), indices, packed.size());
+    } else {
+        for (size_t i = 0; i < indexCount; i++) {
+            uint16_t index = (uint16_t)indices[i];
+            memcpy(&packed[i * 2], &index, 2);
+        }
+    }
+    return packed;
+}
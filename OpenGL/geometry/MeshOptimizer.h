@@ -0,0 +1,53 @@
+#ifndef LEARNOPENGL_MESHOPTIMIZER_H
+#define LEARNOPENGL_MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+// Load time reordering of indexed triangle lists so the GPU does less work per triangle:
+//  - vertex cache order (Forsyth), triangles sharing vertices end up close so the transformed vertices get reused
+//  - overdraw order (optional), clusters of that order sorted so the outward facing ones are drawn first
+//  - fetch order, vertices renumbered in the order they are first used so the vertex fetch reads memory linearly
+// Nothing here touches GL, the statistics come from a simulated FIFO cache so results can be checked without a GPU.
+class MeshOptimizer {
+public:
+    struct CacheStats {
+        float acmr; // Average cache miss ratio, transformed vertices per triangle. 0.5 is ideal, 3 is no reuse at all
+        float atvr; // Average transform to vertex ratio, 1 means every vertex is transformed exactly once
+    };
+
+    struct Report {
+        CacheStats before;
+        CacheStats after;
+        size_t vertexCount;
+        unsigned int indexSize; // Bytes per index, 2 if every index fits GL_UNSIGNED_SHORT
+    };
+
+    // Runs the whole pipeline on float vertices (floatsPerVertex each, position xyz at positionOffset), the
+    // vertices referenced by no triangle are dropped. The result is still floats, ready for VertexFormat::pack
+    static Report optimize(std::vector<float> &vertices, unsigned int floatsPerVertex, std::vector<unsigned int> &indices,
+                           bool overdraw = false, unsigned int positionOffset = 0);
+
+    // Misses of a FIFO post transform cache of the given size over the index list
+    static CacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                         unsigned int cacheSize = 16);
+
+    static void optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                                    size_t vertexCount);
+
+    // Expects a vertex cache optimized list. Cuts it into clusters where that costs little cache efficiency (their
+    // ACMR stays under threshold times the whole mesh) and sorts the clusters front to back as seen from outside
+    static void optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                                 const float* positions, size_t positionStride, size_t vertexCount, float threshold = 1.05f);
+
+    // Renumbers the indices in place by first use and writes the vertices in that order, returns how many were kept
+    static size_t optimizeVertexFetch(void* destination, unsigned int* indices, size_t indexCount, const void* vertices,
+                                      size_t vertexCount, size_t vertexSize);
+
+    static unsigned int indexSize(size_t vertexCount);
+
+    // Index data ready for the EBO in indexSize bytes per index
+    static std::vector<unsigned char> packIndices(const unsigned int* indices, size_t indexCount, unsigned int indexSize);
+};
+
+#endif //LEARNOPENGL_MESHOPTIMIZER_H
@@ -0,0 +1,286 @@
+#include "VertexPacking.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VERTEX_PACKING_SSE2 1
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+static inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline float clamp(float value, float low, float high) {
+    // Written so NaN ends up as low, same as the SIMD max/min below
+    return value > low ? (value < high ? value : high) : low;
+}
+
+// Scalar versions, also used for the tails the SIMD loops leave over
+// ===========================================================================
+
+uint16_t VertexPacking::toHalf(float value) {
+    const uint32_t f32Infinity = 255u << 23;
+    const uint32_t f16Max = (127u + 16u) << 23; // Everything from here up rounds to infinity
+    const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t bits = floatBits(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= f16Max) {
+        half = bits > f32Infinity ? 0x7E00u : 0x7C00u;
+    } else if (bits < (113u << 23)) {
+        // Too small for a normal half, let the float adder do the rounding into the denormal mantissa
+        half = floatBits(bitsFloat(bits) + bitsFloat(denormMagic)) - denormMagic;
+    } else {
+        uint32_t mantissaOdd = (bits >> 13) & 1u;
+        bits += ((uint32_t)(15 - 127) << 23) + 0xFFFu; // Rebias the exponent and round
+        bits += mantissaOdd; // Ties go to even
+        half = bits >> 13;
+    }
+
+    return (uint16_t)(half | (sign >> 16));
+}
+
+float VertexPacking::fromHalf(uint16_t value) {
+    const float magic = bitsFloat(113u << 23);
+    const uint32_t shiftedExponent = 0x7C00u << 13;
+
+    uint32_t bits = ((uint32_t)value & 0x7FFFu) << 13;
+    uint32_t exponent = bits & shiftedExponent;
+    bits += (127u - 15u) << 23;
+
+    if (exponent == shiftedExponent) {
+        bits += (128u - 16u) << 23; // Infinity or NaN
+    } else if (exponent == 0) {
+        bits += 1u << 23; // Denormal, renormalize through the float unit
+        bits = floatBits(bitsFloat(bits) - magic);
+    }
+
+    return bitsFloat(bits | (((uint32_t)value & 0x8000u) << 16));
+}
+
+static inline uint8_t unorm8(float value) {
+    return (uint8_t)(int)(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static inline int8_t snorm8(float value) {
+    float scaled = clamp(value, -1.0f, 1.0f) * 127.0f;
+    return (int8_t)(int)(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+}
+
+static inline int32_t roundAway(float value) {
+    return (int32_t)(value + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+static inline uint32_t snorm1010102(const float* xyzw) {
+    uint32_t x = (uint32_t)roundAway(clamp(xyzw[0], -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    uint32_t y = (uint32_t)roundAway(clamp(xyzw[1], -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    uint32_t z = (uint32_t)roundAway(clamp(xyzw[2], -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    uint32_t w = (uint32_t)roundAway(clamp(xyzw[3], -1.0f, 1.0f)) & 0x3u;
+    return x | (y << 10) | (z << 20) | (w << 30);
+}
+
+static inline uint32_t unorm1010102(const float* xyzw) {
+    uint32_t x = (uint32_t)(int)(clamp(xyzw[0], 0.0f, 1.0f) * 1023.0f + 0.5f);
+    uint32_t y = (uint32_t)(int)(clamp(xyzw[1], 0.0f, 1.0f) * 1023.0f + 0.5f);
+    uint32_t z = (uint32_t)(int)(clamp(xyzw[2], 0.0f, 1.0f) * 1023.0f + 0.5f);
+    uint32_t w = (uint32_t)(int)(clamp(xyzw[3], 0.0f, 1.0f) * 3.0f + 0.5f);
+    return x | (y << 10) | (z << 20) | (w << 30);
+}
+
+#ifdef VERTEX_PACKING_SSE2
+
+// SSE2 helpers
+// ===========================================================================
+
+// Same as the scalar toHalf for 4 values at once, result in the low 16 bits of each lane
+static inline __m128i halfSSE2(__m128 value) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7C00);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32((int)(0xFFFu + ((uint32_t)(15 - 127) << 23)));
+
+    __m128 absolute = _mm_andnot_ps(signMask, value);
+    __m128 sign = _mm_and_ps(signMask, value);
+    __m128i bits = _mm_castps_si128(absolute);
+
+    // Infinity and NaN
+    __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+    __m128i isRegular = _mm_cmpgt_epi32(f16Max, bits);
+    __m128i special = _mm_or_si128(_mm_and_si128(isNaN, nanBit), infinity);
+
+    // Denormals
+    __m128i isDenormal = _mm_cmpgt_epi32(minNormal, bits);
+    __m128 denormalSum = _mm_add_ps(absolute, _mm_castsi128_ps(denormMagic));
+    __m128i denormal = _mm_sub_epi32(_mm_castps_si128(denormalSum), denormMagic);
+
+    // Normals, with round to nearest even
+    __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+    __m128i rounded = _mm_add_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd);
+    __m128i normal = _mm_srli_epi32(rounded, 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+    return _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+
+// Packs the low 16 bits of each lane of two vectors into 8 shorts (packs_epi32 saturates, so sign extend first)
+static inline __m128i packLow16(__m128i low, __m128i high) {
+    low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+    high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+    return _mm_packs_epi32(low, high);
+}
+
+// Rounds half away from zero and truncates, matches roundAway above
+static inline __m128i roundAwaySSE2(__m128 value) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 signedHalf = _mm_or_ps(half, _mm_and_ps(value, _mm_set1_ps(-0.0f)));
+    return _mm_cvttps_epi32(_mm_add_ps(value, signedHalf));
+}
+
+#endif
+
+// Public converters
+// ===========================================================================
+
+void VertexPacking::toHalf(const float *source, uint16_t *destination, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = _mm_cvtps_ph(_mm_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+        __m128i high = _mm_cvtps_ph(_mm_loadu_ps(source + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_unpacklo_epi64(low, high));
+    }
+#elif defined(VERTEX_PACKING_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = halfSSE2(_mm_loadu_ps(source + i));
+        __m128i high = halfSSE2(_mm_loadu_ps(source + i + 4));
+        _mm_storeu_si128((__m128i*)(destination + i), packLow16(low, high));
+    }
+#endif
+    for (; i < count; i++) destination[i] = toHalf(source[i]);
+}
+
+void VertexPacking::toUnorm8(const float *source, uint8_t *destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_PACKING_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i lanes[4];
+        for (int part = 0; part < 4; part++) {
+            // max with the value second turns NaN into 0, like the scalar clamp
+            __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + part * 4), zero), one);
+            lanes[part] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+        }
+        __m128i words = _mm_packs_epi32(lanes[0], lanes[1]);
+        __m128i words2 = _mm_packs_epi32(lanes[2], lanes[3]);
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_packus_epi16(words, words2));
+    }
+#endif
+    for (; i < count; i++) destination[i] = unorm8(source[i]);
+}
+
+void VertexPacking::toSnorm8(const float *source, int8_t *destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_PACKING_SSE2
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(127.0f);
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i lanes[4];
+        for (int part = 0; part < 4; part++) {
+            __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + part * 4), low), high);
+            lanes[part] = roundAwaySSE2(_mm_mul_ps(value, scale));
+        }
+        __m128i words = _mm_packs_epi32(lanes[0], lanes[1]);
+        __m128i words2 = _mm_packs_epi32(lanes[2], lanes[3]);
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi16(words, words2));
+    }
+#endif
+    for (; i < count; i++) destination[i] = snorm8(source[i]);
+}
+
+void VertexPacking::toSnorm1010102(const float *source, uint32_t *destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_PACKING_SSE2
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128i mask10 = _mm_set1_epi32(0x3FF);
+    const __m128i mask2 = _mm_set1_epi32(0x3);
+
+    for (; i + 4 <= count; i += 4) {
+        // Four xyzw values, transposed so every register holds one component of all four
+        __m128 x = _mm_loadu_ps(source + i * 4);
+        __m128 y = _mm_loadu_ps(source + i * 4 + 4);
+        __m128 z = _mm_loadu_ps(source + i * 4 + 8);
+        __m128 w = _mm_loadu_ps(source + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128i xi = roundAwaySSE2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, low), high), scale));
+        __m128i yi = roundAwaySSE2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, low), high), scale));
+        __m128i zi = roundAwaySSE2(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, low), high), scale));
+        __m128i wi = roundAwaySSE2(_mm_min_ps(_mm_max_ps(w, low), high));
+
+        __m128i packed = _mm_and_si128(xi, mask10);
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(yi, mask10), 10));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(zi, mask10), 20));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(wi, mask2), 30));
+        _mm_storeu_si128((__m128i*)(destination + i), packed);
+    }
+#endif
+    for (; i < count; i++) destination[i] = snorm1010102(source + i * 4);
+}
+
+void VertexPacking::toUnorm1010102(const float *source, uint32_t *destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_PACKING_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(1023.0f);
+    const __m128 scaleW = _mm_set1_ps(3.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(source + i * 4);
+        __m128 y = _mm_loadu_ps(source + i * 4 + 4);
+        __m128 z = _mm_loadu_ps(source + i * 4 + 8);
+        __m128 w = _mm_loadu_ps(source + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        // Everything is clamped to 0..1 first, so no masking is needed
+        __m128i xi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, zero), one), scale), half));
+        __m128i yi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, zero), one), scale), half));
+        __m128i zi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, zero), one), scale), half));
+        __m128i wi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(w, zero), one), scaleW), half));
+
+        __m128i packed = _mm_or_si128(xi, _mm_slli_epi32(yi, 10));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(zi, 20));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(wi, 30));
+        _mm_storeu_si128((__m128i*)(destination + i), packed);
+    }
+#endif
+    for (; i < count; i++) destination[i] = unorm1010102(source + i * 4);
+}
@@ -0,0 +1,32 @@
+#ifndef LEARNOPENGL_VERTEXPACKING_H
+#define LEARNOPENGL_VERTEXPACKING_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Converters from 32 bit floats to the compact vertex attribute types, meant to run once at load time.
+// They work on plain contiguous arrays and use SSE2 (and F16C when the compiler targets it) with a scalar fallback,
+// both give bit identical results (F16C keeps NaN payloads, which is the only difference).
+class VertexPacking {
+public:
+    // IEEE half floats, round to nearest even. Overflow becomes infinity, NaN stays NaN
+    static void toHalf(const float* source, uint16_t* destination, size_t count);
+
+    // 0..1 to 0..255 (GL_UNSIGNED_BYTE normalized), values outside the range are clamped
+    static void toUnorm8(const float* source, uint8_t* destination, size_t count);
+
+    // -1..1 to -127..127 (GL_BYTE normalized), values outside the range are clamped
+    static void toSnorm8(const float* source, int8_t* destination, size_t count);
+
+    // xyzw in -1..1 to GL_INT_2_10_10_10_REV, 4 floats in per value out. w only keeps 2 bits (-1, 0 or 1)
+    static void toSnorm1010102(const float* source, uint32_t* destination, size_t count);
+
+    // xyzw in 0..1 to GL_UNSIGNED_INT_2_10_10_10_REV, same layout. w keeps 2 bits (0, 1/3, 2/3 or 1)
+    static void toUnorm1010102(const float* source, uint32_t* destination, size_t count);
+
+    static uint16_t toHalf(float value);
+
+    static float fromHalf(uint16_t value);
+};
+
+#endif //LEARNOPENGL_VERTEXPACKING_H
@@ -0,0 +1,106 @@
+#ifndef LEARNOPENGL_BATCH_H
+#define LEARNOPENGL_BATCH_H
+
+#include <cstddef>
+#include "SIMD.h"
+#include "Vector.h"
+#include "Matrix.h"
+
+// Kernels that run one transform over many elements per call. Points come as structure of arrays (all x, then all
+// y, then all z) so every SIMD lane holds a different point: 8 at a time with AVX, 4 with SSE. The scalar versions
+// are always there to compare against.
+
+// Pointers to the three coordinate arrays of a set of points
+struct PointsSoA {
+    float* x;
+    float* y;
+    float* z;
+};
+
+struct ConstPointsSoA {
+    const float* x;
+    const float* y;
+    const float* z;
+};
+
+// out = m * (p, 1), the w of the result is dropped so this is meant for affine matrices. in and out may be the same
+inline void transformPointsScalar(const mat4 &m, ConstPointsSoA in, PointsSoA out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        out.x[i] = m[0].x * x + m[1].x * y + m[2].x * z + m[3].x;
+        out.y[i] = m[0].y * x + m[1].y * y + m[2].y * z + m[3].y;
+        out.z[i] = m[0].z * x + m[1].z * y + m[2].z * z + m[3].z;
+    }
+}
+
+inline void transformPoints(const mat4 &m, ConstPointsSoA in, PointsSoA out, size_t count) {
+    size_t i = 0;
+#if MATH_AVX
+    // Every matrix element broadcast once, then each row of the result is three multiply adds over 8 points
+    __m256 m00 = _mm256_set1_ps(m[0].x), m10 = _mm256_set1_ps(m[1].x), m20 = _mm256_set1_ps(m[2].x), m30 = _mm256_set1_ps(m[3].x);
+    __m256 m01 = _mm256_set1_ps(m[0].y), m11 = _mm256_set1_ps(m[1].y), m21 = _mm256_set1_ps(m[2].y), m31 = _mm256_set1_ps(m[3].y);
+    __m256 m02 = _mm256_set1_ps(m[0].z), m12 = _mm256_set1_ps(m[1].z), m22 = _mm256_set1_ps(m[2].z), m32 = _mm256_set1_ps(m[3].z);
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(in.x + i), y = _mm256_loadu_ps(in.y + i), z = _mm256_loadu_ps(in.z + i);
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_add_ps(_mm256_mul_ps(m20, z), m30));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_add_ps(_mm256_mul_ps(m21, z), m31));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_add_ps(_mm256_mul_ps(m22, z), m32));
+        _mm256_storeu_ps(out.x + i, rx);
+        _mm256_storeu_ps(out.y + i, ry);
+        _mm256_storeu_ps(out.z + i, rz);
+    }
+#endif
+#if MATH_SSE
+    __m128 s00 = _mm_set1_ps(m[0].x), s10 = _mm_set1_ps(m[1].x), s20 = _mm_set1_ps(m[2].x), s30 = _mm_set1_ps(m[3].x);
+    __m128 s01 = _mm_set1_ps(m[0].y), s11 = _mm_set1_ps(m[1].y), s21 = _mm_set1_ps(m[2].y), s31 = _mm_set1_ps(m[3].y);
+    __m128 s02 = _mm_set1_ps(m[0].z), s12 = _mm_set1_ps(m[1].z), s22 = _mm_set1_ps(m[2].z), s32 = _mm_set1_ps(m[3].z);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(in.x + i), y = _mm_loadu_ps(in.y + i), z = _mm_loadu_ps(in.z + i);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(s00, x), _mm_mul_ps(s10, y)), _mm_add_ps(_mm_mul_ps(s20, z), s30));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(s01, x), _mm_mul_ps(s11, y)), _mm_add_ps(_mm_mul_ps(s21, z), s31));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(s02, x), _mm_mul_ps(s12, y)), _mm_add_ps(_mm_mul_ps(s22, z), s32));
+        _mm_storeu_ps(out.x + i, rx);
+        _mm_storeu_ps(out.y + i, ry);
+        _mm_storeu_ps(out.z + i, rz);
+    }
+#endif
+    transformPointsScalar(m, {in.x + i, in.y + i, in.z + i}, {out.x + i, out.y + i, out.z + i}, count - i);
+}
+
+// out[i] = left * right[i], e.g. one view projection times every model matrix of a frame. out may alias right
+inline void multiplyMatricesScalar(const mat4 &left, const mat4* right, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = mulScalar(left, right[i]);
+}
+
+inline void multiplyMatrices(const mat4 &left, const mat4* right, mat4* out, size_t count) {
+#if MATH_AVX
+    // Two columns of the result per step: the left matrix's columns sit in both halves of the registers
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)&left[0].x), c1 = _mm256_broadcast_ps((const __m128*)&left[1].x);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)&left[2].x), c3 = _mm256_broadcast_ps((const __m128*)&left[3].x);
+    for (size_t i = 0; i < count; i++) {
+        for (int column = 0; column < 4; column += 2) {
+            __m256 b = _mm256_loadu_ps(&right[i][column].x); // Columns column and column + 1, mat4 is only 16 byte aligned
+            __m256 result = _mm256_mul_ps(c0, _mm256_permute_ps(b, 0x00));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c1, _mm256_permute_ps(b, 0x55)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c2, _mm256_permute_ps(b, 0xAA)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c3, _mm256_permute_ps(b, 0xFF)));
+            _mm256_storeu_ps(&out[i][column].x, result);
+        }
+    }
+#elif MATH_SSE
+    for (size_t i = 0; i < count; i++) out[i] = left * right[i];
+#else
+    multiplyMatricesScalar(left, right, out, count);
+#endif
+}
+
+// out[i] = left[i] * right[i]
+inline void multiplyMatrices(const mat4* left, const mat4* right, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = left[i] * right[i];
+}
+
+inline void inverseMatrices(const mat4* in, mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = inverse(in[i]);
+}
+
+#endif //LEARNOPENGL_BATCH_H
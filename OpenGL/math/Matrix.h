@@ -0,0 +1,269 @@
+#ifndef LEARNOPENGL_MATRIX_H
+#define LEARNOPENGL_MATRIX_H
+
+#include <cmath>
+#include "SIMD.h"
+#include "Vector.h"
+
+// Column major like GLSL, m[column][row], so a mat4 can be copied straight into a uniform. Transforms apply right to
+// left: projection * view * model * point.
+
+struct mat3 {
+    vec3 columns[3];
+
+    constexpr mat3() : columns{vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1)} {}
+    constexpr explicit mat3(float diagonal)
+            : columns{vec3(diagonal, 0, 0), vec3(0, diagonal, 0), vec3(0, 0, diagonal)} {}
+    constexpr mat3(const vec3 &c0, const vec3 &c1, const vec3 &c2) : columns{c0, c1, c2} {}
+
+    vec3 &operator[](int i) { return columns[i]; }
+    constexpr const vec3 &operator[](int i) const { return columns[i]; }
+};
+
+struct alignas(16) mat4 {
+    vec4 columns[4];
+
+    constexpr mat4() : columns{vec4(1, 0, 0, 0), vec4(0, 1, 0, 0), vec4(0, 0, 1, 0), vec4(0, 0, 0, 1)} {}
+    constexpr explicit mat4(float diagonal)
+            : columns{vec4(diagonal, 0, 0, 0), vec4(0, diagonal, 0, 0), vec4(0, 0, diagonal, 0),
+                      vec4(0, 0, 0, diagonal)} {}
+    constexpr mat4(const vec4 &c0, const vec4 &c1, const vec4 &c2, const vec4 &c3) : columns{c0, c1, c2, c3} {}
+    constexpr explicit mat4(const mat3 &m)
+            : columns{vec4(m[0], 0), vec4(m[1], 0), vec4(m[2], 0), vec4(0, 0, 0, 1)} {}
+
+    vec4 &operator[](int i) { return columns[i]; }
+    constexpr const vec4 &operator[](int i) const { return columns[i]; }
+
+    const float* data() const { return &columns[0].x; }
+
+    static constexpr mat4 identity() { return mat4(); }
+
+    static constexpr mat4 translate(const vec3 &offset) {
+        return mat4(vec4(1, 0, 0, 0), vec4(0, 1, 0, 0), vec4(0, 0, 1, 0), vec4(offset, 1));
+    }
+
+    static constexpr mat4 scale(const vec3 &factor) {
+        return mat4(vec4(factor.x, 0, 0, 0), vec4(0, factor.y, 0, 0), vec4(0, 0, factor.z, 0), vec4(0, 0, 0, 1));
+    }
+
+    // Right handed, looking down -z, depth mapped to -1..1 like glFrustum
+    static mat4 perspective(float fovY, float aspect, float zNear, float zFar) {
+        float f = 1.0f / std::tan(fovY * 0.5f);
+        return mat4(vec4(f / aspect, 0, 0, 0), vec4(0, f, 0, 0), vec4(0, 0, (zFar + zNear) / (zNear - zFar), -1),
+                    vec4(0, 0, 2.0f * zFar * zNear / (zNear - zFar), 0));
+    }
+
+    static constexpr mat4 orthographic(float left, float right, float bottom, float top, float zNear, float zFar) {
+        return mat4(vec4(2.0f / (right - left), 0, 0, 0), vec4(0, 2.0f / (top - bottom), 0, 0),
+                    vec4(0, 0, -2.0f / (zFar - zNear), 0),
+                    vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom),
+                         -(zFar + zNear) / (zFar - zNear), 1));
+    }
+
+    static mat4 lookAt(const vec3 &eye, const vec3 &target, const vec3 &up) {
+        vec3 forward = normalize(target - eye);
+        vec3 side = normalize(cross(forward, up));
+        vec3 newUp = cross(side, forward);
+        return mat4(vec4(side.x, newUp.x, -forward.x, 0), vec4(side.y, newUp.y, -forward.y, 0),
+                    vec4(side.z, newUp.z, -forward.z, 0),
+                    vec4(-dot(side, eye), -dot(newUp, eye), dot(forward, eye), 1));
+    }
+};
+
+static_assert(sizeof(mat4) == 64, "mat4 has to match a GLSL mat4");
+
+// mat3
+// ===========================================================================
+
+constexpr vec3 operator*(const mat3 &m, const vec3 &v) {
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z;
+}
+
+constexpr mat3 operator*(const mat3 &a, const mat3 &b) {
+    return mat3(a * b[0], a * b[1], a * b[2]);
+}
+
+constexpr mat3 transpose(const mat3 &m) {
+    return mat3(vec3(m[0].x, m[1].x, m[2].x), vec3(m[0].y, m[1].y, m[2].y), vec3(m[0].z, m[1].z, m[2].z));
+}
+
+inline mat3 inverse(const mat3 &m) {
+    // The rows of the inverse are the cross products of the columns over the determinant
+    vec3 r0 = cross(m[1], m[2]);
+    vec3 r1 = cross(m[2], m[0]);
+    vec3 r2 = cross(m[0], m[1]);
+    float inverseDeterminant = 1.0f / dot(m[0], r0);
+    return transpose(mat3(r0 * inverseDeterminant, r1 * inverseDeterminant, r2 * inverseDeterminant));
+}
+
+// Upper left 3x3, and the matrix that transforms normals when the model matrix scales unevenly
+inline mat3 toMat3(const mat4 &m) {
+    return mat3(m[0].xyz(), m[1].xyz(), m[2].xyz());
+}
+
+inline mat3 normalMatrix(const mat4 &model) {
+    return transpose(inverse(toMat3(model)));
+}
+
+// mat4, scalar versions. Always compiled, the operators below use them when there is no SSE
+// ===========================================================================
+
+inline vec4 mulScalar(const mat4 &m, const vec4 &v) {
+    vec4 result;
+    for (int row = 0; row < 4; row++) {
+        result[row] = m[0][row] * v.x + m[1][row] * v.y + m[2][row] * v.z + m[3][row] * v.w;
+    }
+    return result;
+}
+
+inline mat4 mulScalar(const mat4 &a, const mat4 &b) {
+    mat4 result;
+    for (int column = 0; column < 4; column++) result[column] = mulScalar(a, b[column]);
+    return result;
+}
+
+inline mat4 transposeScalar(const mat4 &m) {
+    mat4 result;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) result[column][row] = m[row][column];
+    }
+    return result;
+}
+
+inline mat4 inverseScalar(const mat4 &matrix) {
+    // Cofactor expansion, 2x2 minors of the two upper and two lower rows shared between the cofactors
+    const float* m = matrix.data();
+    float s0 = m[0] * m[5] - m[4] * m[1];
+    float s1 = m[0] * m[9] - m[8] * m[1];
+    float s2 = m[0] * m[13] - m[12] * m[1];
+    float s3 = m[4] * m[9] - m[8] * m[5];
+    float s4 = m[4] * m[13] - m[12] * m[5];
+    float s5 = m[8] * m[13] - m[12] * m[9];
+    float c5 = m[10] * m[15] - m[14] * m[11];
+    float c4 = m[6] * m[15] - m[14] * m[7];
+    float c3 = m[6] * m[11] - m[10] * m[7];
+    float c2 = m[2] * m[15] - m[14] * m[3];
+    float c1 = m[2] * m[11] - m[10] * m[3];
+    float c0 = m[2] * m[7] - m[6] * m[3];
+
+    float inverseDeterminant = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    mat4 result;
+    float* r = &result[0].x;
+    r[0] = (m[5] * c5 - m[9] * c4 + m[13] * c3) * inverseDeterminant;
+    r[1] = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * inverseDeterminant;
+    r[2] = (m[1] * c4 - m[5] * c2 + m[13] * c0) * inverseDeterminant;
+    r[3] = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * inverseDeterminant;
+    r[4] = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * inverseDeterminant;
+    r[5] = (m[0] * c5 - m[8] * c2 + m[12] * c1) * inverseDeterminant;
+    r[6] = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * inverseDeterminant;
+    r[7] = (m[0] * c3 - m[4] * c1 + m[8] * c0) * inverseDeterminant;
+    r[8] = (m[7] * s5 - m[11] * s4 + m[15] * s3) * inverseDeterminant;
+    r[9] = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * inverseDeterminant;
+    r[10] = (m[3] * s4 - m[7] * s2 + m[15] * s0) * inverseDeterminant;
+    r[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * inverseDeterminant;
+    r[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * inverseDeterminant;
+    r[13] = (m[2] * s5 - m[10] * s2 + m[14] * s1) * inverseDeterminant;
+    r[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * inverseDeterminant;
+    r[15] = (m[2] * s3 - m[6] * s1 + m[10] * s0) * inverseDeterminant;
+    return result;
+}
+
+// mat4
+// ===========================================================================
+
+#if MATH_SSE
+inline __m128 mulSSE(const mat4 &m, __m128 v) {
+    __m128 result = _mm_mul_ps(m[0].simd(), MATH_SWIZZLE(v, 0, 0, 0, 0));
+    result = _mm_add_ps(result, _mm_mul_ps(m[1].simd(), MATH_SWIZZLE(v, 1, 1, 1, 1)));
+    result = _mm_add_ps(result, _mm_mul_ps(m[2].simd(), MATH_SWIZZLE(v, 2, 2, 2, 2)));
+    return _mm_add_ps(result, _mm_mul_ps(m[3].simd(), MATH_SWIZZLE(v, 3, 3, 3, 3)));
+}
+
+inline vec4 operator*(const mat4 &m, const vec4 &v) {
+    return vec4(mulSSE(m, v.simd()));
+}
+
+inline mat4 operator*(const mat4 &a, const mat4 &b) {
+    mat4 result;
+    for (int column = 0; column < 4; column++) _mm_store_ps(&result[column].x, mulSSE(a, b[column].simd()));
+    return result;
+}
+
+inline mat4 transpose(const mat4 &m) {
+    __m128 c0 = m[0].simd(), c1 = m[1].simd(), c2 = m[2].simd(), c3 = m[3].simd();
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    return mat4(vec4(c0), vec4(c1), vec4(c2), vec4(c3));
+}
+
+// Products of 2x2 matrices packed as (m00, m01, m10, m11) in one register: A * B, adj(A) * B and A * adj(B)
+inline __m128 mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 1, 2, 2), MATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// Block inverse on the four 2x2 sub matrices. Written for rows, but inverting the transpose gives the transposed
+// inverse, so feeding it columns gives the inverse's columns back
+inline mat4 inverse(const mat4 &m) {
+    __m128 r0 = m[0].simd(), r1 = m[1].simd(), r2 = m[2].simd(), r3 = m[3].simd();
+
+    __m128 a = _mm_movelh_ps(r0, r1);
+    __m128 b = _mm_movehl_ps(r1, r0);
+    __m128 c = _mm_movelh_ps(r2, r3);
+    __m128 d = _mm_movehl_ps(r3, r2);
+
+    // Determinants of the four blocks as (|A|, |B|, |C|, |D|)
+    __m128 determinants = _mm_sub_ps(_mm_mul_ps(MATH_SHUFFLE(r0, r2, 0, 2, 0, 2), MATH_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+                                     _mm_mul_ps(MATH_SHUFFLE(r0, r2, 1, 3, 1, 3), MATH_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    __m128 detA = MATH_SWIZZLE(determinants, 0, 0, 0, 0);
+    __m128 detB = MATH_SWIZZLE(determinants, 1, 1, 1, 1);
+    __m128 detC = MATH_SWIZZLE(determinants, 2, 2, 2, 2);
+    __m128 detD = MATH_SWIZZLE(determinants, 3, 3, 3, 3);
+
+    __m128 dc = mat2AdjMul(d, c);
+    __m128 ab = mat2AdjMul(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 trace = _mm_mul_ps(ab, MATH_SWIZZLE(dc, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, MATH_SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, MATH_SWIZZLE(trace, 1, 0, 3, 2));
+    __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    __m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+    w = _mm_mul_ps(w, scale);
+
+    // Adjugate of each block and back to the 4x4 layout in one shuffle
+    return mat4(vec4(MATH_SHUFFLE(x, y, 3, 1, 3, 1)), vec4(MATH_SHUFFLE(x, y, 2, 0, 2, 0)),
+                vec4(MATH_SHUFFLE(z, w, 3, 1, 3, 1)), vec4(MATH_SHUFFLE(z, w, 2, 0, 2, 0)));
+}
+#else
+inline vec4 operator*(const mat4 &m, const vec4 &v) { return mulScalar(m, v); }
+inline mat4 operator*(const mat4 &a, const mat4 &b) { return mulScalar(a, b); }
+inline mat4 transpose(const mat4 &m) { return transposeScalar(m); }
+inline mat4 inverse(const mat4 &m) { return inverseScalar(m); }
+#endif
+
+inline mat4 &operator*=(mat4 &a, const mat4 &b) { return a = a * b; }
+
+// Points get w = 1, directions w = 0
+inline vec3 transformPoint(const mat4 &m, const vec3 &point) { return (m * vec4(point, 1.0f)).xyz(); }
+inline vec3 transformDirection(const mat4 &m, const vec3 &direction) { return (m * vec4(direction, 0.0f)).xyz(); }
+
+#endif //LEARNOPENGL_MATRIX_H
@@ -0,0 +1,97 @@
+#ifndef LEARNOPENGL_QUATERNION_H
+#define LEARNOPENGL_QUATERNION_H
+
+#include <cmath>
+#include "SIMD.h"
+#include "Vector.h"
+#include "Matrix.h"
+
+// Unit quaternions for rotations, xyz the axis part and w the angle part
+struct alignas(16) quat {
+    float x, y, z, w;
+
+    constexpr quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+    constexpr quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+    static constexpr quat identity() { return quat(); }
+
+    // Angle in radians around a normalized axis
+    static quat angleAxis(float angle, const vec3 &axis) {
+        float s = std::sin(angle * 0.5f);
+        return quat(axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f));
+    }
+
+    constexpr vec3 xyz() const { return vec3(x, y, z); }
+};
+
+// Hamilton product, a * b rotates by b first and then by a
+inline quat operator*(const quat &a, const quat &b) {
+#if MATH_SSE
+    __m128 qa = _mm_load_ps(&a.x), qb = _mm_load_ps(&b.x);
+    // w = aw*bw - dot(axes), the other three follow the cross product pattern with signs flipped on the last lane
+    __m128 result = _mm_mul_ps(MATH_SWIZZLE(qa, 3, 3, 3, 3), qb);
+    __m128 sign = _mm_setr_ps(0.0f, 0.0f, 0.0f, -0.0f);
+    result = _mm_add_ps(result, _mm_xor_ps(_mm_mul_ps(MATH_SWIZZLE(qa, 0, 1, 2, 0), MATH_SWIZZLE(qb, 3, 3, 3, 0)), sign));
+    result = _mm_add_ps(result, _mm_xor_ps(_mm_mul_ps(MATH_SWIZZLE(qa, 1, 2, 0, 1), MATH_SWIZZLE(qb, 2, 0, 1, 1)), sign));
+    result = _mm_sub_ps(result, _mm_mul_ps(MATH_SWIZZLE(qa, 2, 0, 1, 2), MATH_SWIZZLE(qb, 1, 2, 0, 2)));
+    quat product;
+    _mm_store_ps(&product.x, result);
+    return product;
+#else
+    return quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y + a.y * b.w + a.z * b.x - a.x * b.z,
+                a.w * b.z + a.z * b.w + a.x * b.y - a.y * b.x,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+#endif
+}
+
+constexpr quat conjugate(const quat &q) { return quat(-q.x, -q.y, -q.z, q.w); }
+
+constexpr float dot(const quat &a, const quat &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline quat normalize(const quat &q) {
+    float scale = 1.0f / std::sqrt(dot(q, q));
+    return quat(q.x * scale, q.y * scale, q.z * scale, q.w * scale);
+}
+
+inline vec3 rotate(const quat &q, const vec3 &v) {
+    // v + 2w (q x v) + 2 q x (q x v), cheaper than going through a matrix for a single vector
+    vec3 axis = q.xyz();
+    vec3 t = cross(axis, v) * 2.0f;
+    return v + t * q.w + cross(axis, t);
+}
+
+// Shortest path interpolation, falls back to a normalized lerp when the two are almost the same
+inline quat slerp(const quat &a, const quat &b, float t) {
+    float cosine = dot(a, b);
+    quat end = cosine < 0.0f ? quat(-b.x, -b.y, -b.z, -b.w) : b;
+    cosine = std::fabs(cosine);
+
+    float weightA = 1.0f - t, weightB = t;
+    if (cosine < 0.9995f) {
+        float angle = std::acos(cosine);
+        float inverseSine = 1.0f / std::sin(angle);
+        weightA = std::sin((1.0f - t) * angle) * inverseSine;
+        weightB = std::sin(t * angle) * inverseSine;
+    }
+    quat result(a.x * weightA + end.x * weightB, a.y * weightA + end.y * weightB, a.z * weightA + end.z * weightB,
+                a.w * weightA + end.w * weightB);
+    return cosine < 0.9995f ? result : normalize(result);
+}
+
+inline mat3 toMat3(const quat &q) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    return mat3(vec3(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy)),
+                vec3(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx)),
+                vec3(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy)));
+}
+
+inline mat4 toMat4(const quat &q) {
+    return mat4(toMat3(q));
+}
+
+static_assert(sizeof(quat) == 16, "quat has to be 4 floats");
+
+#endif //LEARNOPENGL_QUATERNION_H
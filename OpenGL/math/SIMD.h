@@ -0,0 +1,26 @@
+#ifndef LEARNOPENGL_SIMD_H
+#define LEARNOPENGL_SIMD_H
+
+// Which instruction sets the math headers use. SSE2 is there on every x86-64 compiler, AVX only when the compiler is
+// told to target it (-mavx). Defining MATH_NO_SIMD before including any of them forces the scalar code everywhere,
+// the scalar versions (mulScalar, inverseScalar...) are always available next to the SIMD ones to compare against.
+#if !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SSE 1
+#include <emmintrin.h>
+#else
+#define MATH_SSE 0
+#endif
+
+#if MATH_SSE && defined(__AVX__)
+#define MATH_AVX 1
+#include <immintrin.h>
+#else
+#define MATH_AVX 0
+#endif
+
+#if MATH_SSE
+#define MATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+#define MATH_SWIZZLE(v, x, y, z, w) MATH_SHUFFLE(v, v, x, y, z, w)
+#endif
+
+#endif //LEARNOPENGL_SIMD_H
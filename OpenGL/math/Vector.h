@@ -0,0 +1,134 @@
+#ifndef LEARNOPENGL_VECTOR_H
+#define LEARNOPENGL_VECTOR_H
+
+#include <cmath>
+#include "SIMD.h"
+
+// GLSL style vectors. vec2 and vec3 are plain floats, tightly packed so they can sit in vertex data as is. vec4 is
+// 16 byte aligned and its arithmetic goes through SSE. All of them can be built in constant expressions.
+
+struct vec2 {
+    float x, y;
+
+    constexpr vec2() : x(0.0f), y(0.0f) {}
+    constexpr explicit vec2(float value) : x(value), y(value) {}
+    constexpr vec2(float x, float y) : x(x), y(y) {}
+
+    float &operator[](int i) { return (&x)[i]; }
+    const float &operator[](int i) const { return (&x)[i]; }
+};
+
+struct vec3 {
+    float x, y, z;
+
+    constexpr vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr explicit vec3(float value) : x(value), y(value), z(value) {}
+    constexpr vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+    constexpr vec3(const vec2 &xy, float z) : x(xy.x), y(xy.y), z(z) {}
+
+    float &operator[](int i) { return (&x)[i]; }
+    const float &operator[](int i) const { return (&x)[i]; }
+};
+
+struct alignas(16) vec4 {
+    float x, y, z, w;
+
+    constexpr vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr explicit vec4(float value) : x(value), y(value), z(value), w(value) {}
+    constexpr vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    constexpr vec4(const vec3 &xyz, float w) : x(xyz.x), y(xyz.y), z(xyz.z), w(w) {}
+
+    constexpr vec3 xyz() const { return vec3(x, y, z); }
+
+    float &operator[](int i) { return (&x)[i]; }
+    const float &operator[](int i) const { return (&x)[i]; }
+
+#if MATH_SSE
+    explicit vec4(__m128 value) { _mm_store_ps(&x, value); }
+    __m128 simd() const { return _mm_load_ps(&x); }
+#endif
+};
+
+// vec2
+// ===========================================================================
+
+constexpr vec2 operator+(const vec2 &a, const vec2 &b) { return vec2(a.x + b.x, a.y + b.y); }
+constexpr vec2 operator-(const vec2 &a, const vec2 &b) { return vec2(a.x - b.x, a.y - b.y); }
+constexpr vec2 operator*(const vec2 &a, const vec2 &b) { return vec2(a.x * b.x, a.y * b.y); }
+constexpr vec2 operator/(const vec2 &a, const vec2 &b) { return vec2(a.x / b.x, a.y / b.y); }
+constexpr vec2 operator*(const vec2 &a, float s) { return vec2(a.x * s, a.y * s); }
+constexpr vec2 operator*(float s, const vec2 &a) { return a * s; }
+constexpr vec2 operator/(const vec2 &a, float s) { return vec2(a.x / s, a.y / s); }
+constexpr vec2 operator-(const vec2 &a) { return vec2(-a.x, -a.y); }
+inline vec2 &operator+=(vec2 &a, const vec2 &b) { return a = a + b; }
+inline vec2 &operator-=(vec2 &a, const vec2 &b) { return a = a - b; }
+inline vec2 &operator*=(vec2 &a, float s) { return a = a * s; }
+
+constexpr float dot(const vec2 &a, const vec2 &b) { return a.x * b.x + a.y * b.y; }
+inline float length(const vec2 &a) { return std::sqrt(dot(a, a)); }
+inline vec2 normalize(const vec2 &a) { return a / length(a); }
+
+// vec3
+// ===========================================================================
+
+constexpr vec3 operator+(const vec3 &a, const vec3 &b) { return vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+constexpr vec3 operator-(const vec3 &a, const vec3 &b) { return vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+constexpr vec3 operator*(const vec3 &a, const vec3 &b) { return vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+constexpr vec3 operator/(const vec3 &a, const vec3 &b) { return vec3(a.x / b.x, a.y / b.y, a.z / b.z); }
+constexpr vec3 operator*(const vec3 &a, float s) { return vec3(a.x * s, a.y * s, a.z * s); }
+constexpr vec3 operator*(float s, const vec3 &a) { return a * s; }
+constexpr vec3 operator/(const vec3 &a, float s) { return vec3(a.x / s, a.y / s, a.z / s); }
+constexpr vec3 operator-(const vec3 &a) { return vec3(-a.x, -a.y, -a.z); }
+inline vec3 &operator+=(vec3 &a, const vec3 &b) { return a = a + b; }
+inline vec3 &operator-=(vec3 &a, const vec3 &b) { return a = a - b; }
+inline vec3 &operator*=(vec3 &a, float s) { return a = a * s; }
+
+constexpr float dot(const vec3 &a, const vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr vec3 cross(const vec3 &a, const vec3 &b) {
+    return vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline float length(const vec3 &a) { return std::sqrt(dot(a, a)); }
+inline vec3 normalize(const vec3 &a) { return a / length(a); }
+constexpr vec3 lerp(const vec3 &a, const vec3 &b, float t) { return a + (b - a) * t; }
+
+// vec4
+// ===========================================================================
+
+#if MATH_SSE
+inline vec4 operator+(const vec4 &a, const vec4 &b) { return vec4(_mm_add_ps(a.simd(), b.simd())); }
+inline vec4 operator-(const vec4 &a, const vec4 &b) { return vec4(_mm_sub_ps(a.simd(), b.simd())); }
+inline vec4 operator*(const vec4 &a, const vec4 &b) { return vec4(_mm_mul_ps(a.simd(), b.simd())); }
+inline vec4 operator/(const vec4 &a, const vec4 &b) { return vec4(_mm_div_ps(a.simd(), b.simd())); }
+inline vec4 operator*(const vec4 &a, float s) { return vec4(_mm_mul_ps(a.simd(), _mm_set1_ps(s))); }
+inline vec4 operator-(const vec4 &a) { return vec4(_mm_xor_ps(a.simd(), _mm_set1_ps(-0.0f))); }
+
+inline float dot(const vec4 &a, const vec4 &b) {
+    __m128 product = _mm_mul_ps(a.simd(), b.simd());
+    __m128 sum = _mm_add_ps(product, MATH_SWIZZLE(product, 2, 3, 0, 1));
+    sum = _mm_add_ss(sum, MATH_SWIZZLE(sum, 1, 0, 3, 2));
+    return _mm_cvtss_f32(sum);
+}
+#else
+inline vec4 operator+(const vec4 &a, const vec4 &b) { return vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline vec4 operator-(const vec4 &a, const vec4 &b) { return vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline vec4 operator*(const vec4 &a, const vec4 &b) { return vec4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+inline vec4 operator/(const vec4 &a, const vec4 &b) { return vec4(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w); }
+inline vec4 operator*(const vec4 &a, float s) { return vec4(a.x * s, a.y * s, a.z * s, a.w * s); }
+inline vec4 operator-(const vec4 &a) { return vec4(-a.x, -a.y, -a.z, -a.w); }
+
+inline float dot(const vec4 &a, const vec4 &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+#endif
+
+inline vec4 operator*(float s, const vec4 &a) { return a * s; }
+inline vec4 operator/(const vec4 &a, float s) { return a * (1.0f / s); }
+inline vec4 &operator+=(vec4 &a, const vec4 &b) { return a = a + b; }
+inline vec4 &operator-=(vec4 &a, const vec4 &b) { return a = a - b; }
+inline vec4 &operator*=(vec4 &a, float s) { return a = a * s; }
+
+inline float length(const vec4 &a) { return std::sqrt(dot(a, a)); }
+inline vec4 normalize(const vec4 &a) { return a / length(a); }
+inline vec4 lerp(const vec4 &a, const vec4 &b, float t) { return a + (b - a) * t; }
+
+static_assert(sizeof(vec2) == 8 && sizeof(vec3) == 12 && sizeof(vec4) == 16, "Vectors have to be tightly packed");
+
+#endif //LEARNOPENGL_VECTOR_H
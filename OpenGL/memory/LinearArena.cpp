@@ -0,0 +1,40 @@
+#include "LinearArena.h"
+#include <cstdint>
+
+LinearArena::LinearArena(size_t blockSize) : blockSize(blockSize) {}
+
+void *LinearArena::allocate(size_t size, size_t alignment) {
+    // Try the current block, then the ones kept from earlier frames, then make a new one big enough
+    for (; current < blocks.size(); current++, offset = 0) {
+        Block &block = blocks[current];
+        auto base = (uintptr_t)block.memory.get();
+        uintptr_t start = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (start + size <= base + block.size) {
+            offset = start + size - base;
+            used += size;
+            return (void*)start;
+        }
+    }
+
+    size_t newSize = size + alignment > blockSize ? size + alignment : blockSize;
+    blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[newSize]), newSize});
+    current = blocks.size() - 1;
+    offset = 0;
+    return allocate(size, alignment);
+}
+
+void LinearArena::reset() {
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t LinearArena::getUsed() const {
+    return used;
+}
+
+size_t LinearArena::getCapacity() const {
+    size_t capacity = 0;
+    for (const Block &block : blocks) capacity += block.size;
+    return capacity;
+}
@@ -0,0 +1,43 @@
+#ifndef LEARNOPENGL_LINEARARENA_H
+#define LEARNOPENGL_LINEARARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that lives for one frame. Allocating is moving an offset, there is no free, reset drops
+// everything at once and keeps the blocks so a steady state frame never reaches malloc. Not thread safe, meant to
+// be owned by one thread. Nothing is constructed or destroyed, only use it for plain data.
+class LinearArena {
+public:
+    explicit LinearArena(size_t blockSize = 64 * 1024);
+
+    // Alignment has to be a power of two
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template<typename T>
+    T* allocate(size_t count = 1) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset();
+
+    // Bytes handed out since the last reset, and bytes held in blocks
+    size_t getUsed() const;
+
+    size_t getCapacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t current = 0; // Block being bumped
+    size_t offset = 0; // Into the current block
+    size_t used = 0;
+};
+
+#endif //LEARNOPENGL_LINEARARENA_H
@@ -0,0 +1,248 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+
+// Index of the highest / lowest set bit, value must not be 0
+static int highestBit(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - __builtin_clz(value);
+#else
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+#endif
+}
+
+static int lowestBit(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(value);
+#else
+    int bit = 0;
+    while ((value & 1u) == 0) { value >>= 1; bit++; }
+    return bit;
+#endif
+}
+
+RangeAllocator::RangeAllocator(uint32_t capacity) : capacity(capacity) {
+    resetBins();
+    if (capacity > 0) {
+        firstBlock = newBlock(0, capacity);
+        insertFree(firstBlock);
+    }
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size) {
+    if (size == 0) size = 1;
+    if (size > capacity - used) return INVALID;
+
+    uint32_t block = findFree(size);
+    if (block == INVALID) return INVALID;
+    removeFree(block);
+
+    // Whatever is left past the request goes back as a free block of its own
+    if (blocks[block].size > size) {
+        uint32_t rest = newBlock(blocks[block].offset + size, blocks[block].size - size);
+        blocks[block].size = size;
+        blocks[rest].previousPhysical = block;
+        blocks[rest].nextPhysical = blocks[block].nextPhysical;
+        if (blocks[rest].nextPhysical != INVALID) blocks[blocks[rest].nextPhysical].previousPhysical = rest;
+        blocks[block].nextPhysical = rest;
+        insertFree(rest);
+    }
+
+    blocks[block].free = false;
+    used += size;
+    allocations++;
+    return block;
+}
+
+void RangeAllocator::free(uint32_t handle) {
+    if (handle >= blocks.size() || blocks[handle].free) return;
+    used -= blocks[handle].size;
+    allocations--;
+
+    uint32_t block = handle;
+    blocks[block].free = true;
+
+    uint32_t next = blocks[block].nextPhysical;
+    if (next != INVALID && blocks[next].free) {
+        removeFree(next);
+        blocks[block].size += blocks[next].size;
+        blocks[block].nextPhysical = blocks[next].nextPhysical;
+        if (blocks[block].nextPhysical != INVALID) blocks[blocks[block].nextPhysical].previousPhysical = block;
+        unusedBlocks.push_back(next);
+    }
+
+    uint32_t previous = blocks[block].previousPhysical;
+    if (previous != INVALID && blocks[previous].free) {
+        removeFree(previous);
+        blocks[previous].size += blocks[block].size;
+        blocks[previous].nextPhysical = blocks[block].nextPhysical;
+        if (blocks[previous].nextPhysical != INVALID) blocks[blocks[previous].nextPhysical].previousPhysical = previous;
+        unusedBlocks.push_back(block);
+        block = previous;
+    }
+
+    insertFree(block);
+}
+
+uint32_t RangeAllocator::offsetOf(uint32_t handle) const {
+    return blocks[handle].offset;
+}
+
+uint32_t RangeAllocator::sizeOf(uint32_t handle) const {
+    return blocks[handle].size;
+}
+
+std::vector<RangeAllocator::Move> RangeAllocator::defragment() {
+    std::vector<Move> moves;
+
+    if (firstBlock == INVALID) return moves;
+
+    // Keep the allocations in the same order, packed from 0, and drop all the free blocks
+    uint32_t cursor = 0;
+    uint32_t previous = INVALID, lowestUsed = INVALID;
+    for (uint32_t block = firstBlock; block != INVALID;) {
+        uint32_t next = blocks[block].nextPhysical;
+        if (blocks[block].free) {
+            unusedBlocks.push_back(block);
+        } else {
+            if (blocks[block].offset != cursor) moves.push_back({block, blocks[block].offset, cursor, blocks[block].size});
+            blocks[block].offset = cursor;
+            blocks[block].previousPhysical = previous;
+            if (previous != INVALID) blocks[previous].nextPhysical = block;
+            else lowestUsed = block;
+            cursor += blocks[block].size;
+            previous = block;
+        }
+        block = next;
+    }
+
+    resetBins();
+    uint32_t tail = INVALID;
+    if (cursor < capacity) {
+        tail = newBlock(cursor, capacity - cursor);
+        blocks[tail].previousPhysical = previous;
+        insertFree(tail);
+    }
+    if (previous != INVALID) blocks[previous].nextPhysical = tail;
+
+    firstBlock = lowestUsed != INVALID ? lowestUsed : tail;
+    return moves;
+}
+
+RangeAllocator::Stats RangeAllocator::stats() const {
+    Stats stats = {capacity, used, allocations, 0, 0, 0.0f};
+
+    uint32_t levels = firstLevelMap;
+    while (levels != 0) {
+        int firstLevel = lowestBit(levels);
+        levels &= levels - 1;
+        for (uint32_t bin = 0; bin < SECOND_LEVELS; bin++) {
+            for (uint32_t block = bins[firstLevel][bin]; block != INVALID; block = blocks[block].nextFree) {
+                stats.freeBlocks++;
+                stats.largestFree = std::max(stats.largestFree, blocks[block].size);
+            }
+        }
+    }
+
+    uint32_t freeSpace = capacity - used;
+    stats.fragmentation = freeSpace > 0 ? 1.0f - (float)stats.largestFree / freeSpace : 0.0f;
+    return stats;
+}
+
+uint32_t RangeAllocator::getCapacity() const {
+    return capacity;
+}
+
+void RangeAllocator::mapping(uint32_t size, int &firstLevel, int &secondLevel) {
+    // Sizes below SECOND_LEVELS get one bin each in level 0, above that every power of two range is split in
+    // SECOND_LEVELS equal bins
+    if (size < SECOND_LEVELS) {
+        firstLevel = 0;
+        secondLevel = (int)size;
+    } else {
+        int bit = highestBit(size);
+        firstLevel = bit - SECOND_LEVEL_BITS + 1;
+        secondLevel = (int)((size >> (bit - SECOND_LEVEL_BITS)) - SECOND_LEVELS);
+    }
+}
+
+uint32_t RangeAllocator::findFree(uint32_t size) const {
+    // Round the request up to the start of the next bin, then any block in that bin or above fits without a search
+    uint32_t rounded = size;
+    if (size >= SECOND_LEVELS) {
+        uint32_t step = (1u << (highestBit(size) - SECOND_LEVEL_BITS)) - 1;
+        rounded = size + step < size ? size : size + step;
+    }
+
+    int firstLevel, secondLevel;
+    mapping(rounded, firstLevel, secondLevel);
+
+    uint32_t candidates = secondLevelMap[firstLevel] & (~0u << secondLevel);
+    if (candidates == 0) {
+        uint32_t levels = firstLevel + 1 < FIRST_LEVELS ? firstLevelMap & (~0u << (firstLevel + 1)) : 0;
+        if (levels != 0) {
+            firstLevel = lowestBit(levels);
+            candidates = secondLevelMap[firstLevel];
+        }
+    }
+    if (candidates != 0) return bins[firstLevel][lowestBit(candidates)];
+
+    // Nothing is sure to fit, but the request's own bin can still hold a block that happens to be big enough.
+    // Without this a nearly full arena would refuse sizes it has room for
+    mapping(size, firstLevel, secondLevel);
+    for (uint32_t block = bins[firstLevel][secondLevel]; block != INVALID; block = blocks[block].nextFree) {
+        if (blocks[block].size >= size) return block;
+    }
+    return INVALID;
+}
+
+uint32_t RangeAllocator::newBlock(uint32_t offset, uint32_t size) {
+    Block block = {offset, size, INVALID, INVALID, INVALID, INVALID, true};
+    if (!unusedBlocks.empty()) {
+        uint32_t index = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[index] = block;
+        return index;
+    }
+    blocks.push_back(block);
+    return (uint32_t)blocks.size() - 1;
+}
+
+void RangeAllocator::insertFree(uint32_t block) {
+    int firstLevel, secondLevel;
+    mapping(blocks[block].size, firstLevel, secondLevel);
+
+    uint32_t head = bins[firstLevel][secondLevel];
+    blocks[block].free = true;
+    blocks[block].previousFree = INVALID;
+    blocks[block].nextFree = head;
+    if (head != INVALID) blocks[head].previousFree = block;
+    bins[firstLevel][secondLevel] = block;
+
+    firstLevelMap |= 1u << firstLevel;
+    secondLevelMap[firstLevel] |= 1u << secondLevel;
+}
+
+void RangeAllocator::removeFree(uint32_t block) {
+    int firstLevel, secondLevel;
+    mapping(blocks[block].size, firstLevel, secondLevel);
+
+    uint32_t previous = blocks[block].previousFree, next = blocks[block].nextFree;
+    if (previous != INVALID) blocks[previous].nextFree = next;
+    else bins[firstLevel][secondLevel] = next;
+    if (next != INVALID) blocks[next].previousFree = previous;
+
+    if (bins[firstLevel][secondLevel] == INVALID) {
+        secondLevelMap[firstLevel] &= ~(1u << secondLevel);
+        if (secondLevelMap[firstLevel] == 0) firstLevelMap &= ~(1u << firstLevel);
+    }
+}
+
+void RangeAllocator::resetBins() {
+    firstLevelMap = 0;
+    for (int firstLevel = 0; firstLevel < FIRST_LEVELS; firstLevel++) {
+        secondLevelMap[firstLevel] = 0;
+        for (uint32_t bin = 0; bin < SECOND_LEVELS; bin++) bins[firstLevel][bin] = INVALID;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef LEARNOPENGL_RANGEALLOCATOR_H
+#define LEARNOPENGL_RANGEALLOCATOR_H
+
+#include <cstdint>
+#include <vector>
+
+// Hands out ranges of a fixed size space with the TLSF scheme (two level segregated fit): free blocks are kept in
+// bins by size, two bitmaps find a bin that surely fits in constant time, and freed blocks merge with free neighbours
+// right away. It only does the bookkeeping, the units can be bytes, vertices or indices, so it runs and can be tested
+// without a GL context. BufferArena puts a GL buffer behind it.
+class RangeAllocator {
+public:
+    static const uint32_t INVALID = 0xFFFFFFFFu;
+
+    struct Stats {
+        uint32_t capacity;
+        uint32_t used;
+        uint32_t allocations;
+        uint32_t freeBlocks;
+        uint32_t largestFree;
+        float fragmentation; // 1 - largestFree / free space, 0 when all the free space is one block
+    };
+
+    // A block that changed place during defragment, the data has to be copied from -> to by the owner
+    struct Move {
+        uint32_t handle;
+        uint32_t from;
+        uint32_t to;
+        uint32_t size;
+    };
+
+    explicit RangeAllocator(uint32_t capacity);
+
+    // Returns a handle that stays valid until free, INVALID if no free block is big enough
+    uint32_t allocate(uint32_t size);
+
+    void free(uint32_t handle);
+
+    // Where the range starts. Can change with defragment, so it is looked up when needed rather than kept around
+    uint32_t offsetOf(uint32_t handle) const;
+
+    uint32_t sizeOf(uint32_t handle) const;
+
+    // Slides every allocation down so all the free space ends up in one block at the end, handles stay the same.
+    // Returns the moves in address order, every one goes to a lower offset
+    std::vector<Move> defragment();
+
+    Stats stats() const;
+
+    uint32_t getCapacity() const;
+
+private:
+    static const int SECOND_LEVEL_BITS = 4;
+    static const uint32_t SECOND_LEVELS = 1u << SECOND_LEVEL_BITS;
+    static const int FIRST_LEVELS = 32;
+
+    struct Block {
+        uint32_t offset;
+        uint32_t size;
+        uint32_t previousPhysical; // Neighbours by address
+        uint32_t nextPhysical;
+        uint32_t previousFree; // Neighbours in the bin, only meaningful while free
+        uint32_t nextFree;
+        bool free;
+    };
+
+    uint32_t capacity;
+    uint32_t used = 0;
+    uint32_t allocations = 0;
+    std::vector<Block> blocks;
+    std::vector<uint32_t> unusedBlocks; // Slots of blocks that were merged away, reused by the next split
+    uint32_t firstBlock = INVALID; // The one at offset 0, never merged into another since merges keep the lower block
+
+    uint32_t firstLevelMap = 0;
+    uint32_t secondLevelMap[FIRST_LEVELS] = {};
+    uint32_t bins[FIRST_LEVELS][SECOND_LEVELS];
+
+    static void mapping(uint32_t size, int &firstLevel, int &secondLevel);
+
+    uint32_t findFree(uint32_t size) const;
+
+    uint32_t newBlock(uint32_t offset, uint32_t size);
+
+    void insertFree(uint32_t block);
+
+    void removeFree(uint32_t block);
+
+    void resetBins();
+};
+
+#endif //LEARNOPENGL_RANGEALLOCATOR_H
@@ -0,0 +1,73 @@
+#include "BufferArena.h"
+#include "GLState.h"
+
+BufferArena::BufferArena(unsigned int unitSize, unsigned int capacity) : unitSize(unitSize), allocator(capacity) {
+    glGenBuffers(1, &ID);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * unitSize, nullptr, GL_STATIC_DRAW);
+}
+
+BufferArena::~BufferArena() {
+    glDeleteBuffers(1, &ID);
+    GLState::forgetBuffer(ID);
+}
+
+unsigned int BufferArena::allocate(unsigned int units) {
+    return allocator.allocate(units);
+}
+
+void BufferArena::free(unsigned int handle) {
+    allocator.free(handle);
+}
+
+void BufferArena::write(unsigned int handle, const void *data, unsigned int units, unsigned int unitOffset) {
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(allocator.offsetOf(handle) + unitOffset) * unitSize,
+                    (GLsizeiptr)units * unitSize, data);
+}
+
+unsigned int BufferArena::offsetOf(unsigned int handle) const {
+    return allocator.offsetOf(handle);
+}
+
+size_t BufferArena::defragment() {
+    std::vector<RangeAllocator::Move> moves = allocator.defragment();
+    if (moves.empty()) return 0;
+
+    // glCopyBufferSubData can't copy between overlapping parts of one buffer, and a range sliding down by less than
+    // its size overlaps itself. So everything that moves goes to a scratch buffer at its new place first, then comes
+    // back in one copy: every range after the first move moves too, so the new positions are one contiguous span
+    GLintptr begin = (GLintptr)moves.front().to * unitSize;
+    GLintptr end = (GLintptr)(moves.back().to + moves.back().size) * unitSize;
+
+    unsigned int scratch;
+    glGenBuffers(1, &scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    glBufferData(GL_COPY_WRITE_BUFFER, end - begin, nullptr, GL_STREAM_COPY);
+
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, ID);
+    for (const RangeAllocator::Move &move : moves) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)move.from * unitSize,
+                            (GLintptr)move.to * unitSize - begin, (GLsizeiptr)move.size * unitSize);
+    }
+
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, begin, end - begin);
+
+    glDeleteBuffers(1, &scratch);
+    GLState::forgetBuffer(scratch);
+    return moves.size();
+}
+
+RangeAllocator::Stats BufferArena::stats() const {
+    return allocator.stats();
+}
+
+unsigned int BufferArena::getID() const {
+    return ID;
+}
+
+unsigned int BufferArena::getUnitSize() const {
+    return unitSize;
+}
@@ -0,0 +1,48 @@
+#ifndef LEARNOPENGL_BUFFERARENA_H
+#define LEARNOPENGL_BUFFERARENA_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "../memory/RangeAllocator.h"
+
+// One large GL buffer split into ranges by a RangeAllocator, so many meshes share a buffer object instead of each
+// having its own. Everything is counted in units (a vertex, an index...), offsets can be used as base vertex or
+// first index directly.
+class BufferArena {
+public:
+    BufferArena(unsigned int unitSize, unsigned int capacity);
+
+    ~BufferArena();
+
+    BufferArena(const BufferArena &) = delete;
+
+    BufferArena &operator=(const BufferArena &) = delete;
+
+    // RangeAllocator::INVALID when the arena is full
+    unsigned int allocate(unsigned int units);
+
+    void free(unsigned int handle);
+
+    // Copies units worth of data into the range, starting unitOffset units into it
+    void write(unsigned int handle, const void* data, unsigned int units, unsigned int unitOffset = 0);
+
+    // In units, changes when the arena is defragmented
+    unsigned int offsetOf(unsigned int handle) const;
+
+    // Packs every range at the front of the buffer. The buffer keeps its name so VAOs pointing at it stay valid,
+    // only the offsets move. Returns how many ranges were moved
+    size_t defragment();
+
+    RangeAllocator::Stats stats() const;
+
+    unsigned int getID() const;
+
+    unsigned int getUnitSize() const;
+
+private:
+    unsigned int ID = 0;
+    unsigned int unitSize;
+    RangeAllocator allocator;
+};
+
+#endif //LEARNOPENGL_BUFFERARENA_H
@@ -0,0 +1,35 @@
+#include "CommandBuffer.h"
+
+CommandBuffer::CommandBuffer(size_t arenaBlockSize) : arena(arenaBlockSize) {}
+
+void CommandBuffer::submit(const DrawCommand &command, uint64_t key) {
+    if (last == nullptr || last->count == Page::PACKETS) {
+        Page* page = arena.allocate<Page>();
+        page->next = nullptr;
+        page->count = 0;
+        if (last) {
+            last->next = page;
+        } else {
+            first = page;
+        }
+        last = page;
+    }
+
+    last->packets[last->count++] = {key, command};
+    count++;
+}
+
+void CommandBuffer::reset() {
+    arena.reset();
+    first = nullptr;
+    last = nullptr;
+    count = 0;
+}
+
+size_t CommandBuffer::size() const {
+    return count;
+}
+
+const CommandBuffer::Page *CommandBuffer::firstPage() const {
+    return first;
+}
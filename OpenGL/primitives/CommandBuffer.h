@@ -0,0 +1,67 @@
+#ifndef LEARNOPENGL_COMMANDBUFFER_H
+#define LEARNOPENGL_COMMANDBUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include "../core/CacheLine.h"
+#include "../memory/LinearArena.h"
+
+// Everything needed to issue one draw, plain data so a frame worth of them sits in one array
+struct DrawCommand {
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int texture; // Bound to GL_TEXTURE_2D on unit 0, 0 for none
+    unsigned int uniformBuffer; // Per object uniform range, uniformSize 0 for none
+    unsigned int uniformBinding;
+    unsigned int uniformOffset;
+    unsigned int uniformSize;
+    GLenum mode; // GL_TRIANGLES...
+    GLenum indexType;
+    int count;
+    unsigned int indexOffset; // In bytes
+    int baseVertex; // Added to every index, lets sub-meshes of one buffer keep their own numbering
+    int instanceCount; // Above 1 draws with glDrawElementsInstanced
+};
+
+// A list of draws recorded by one thread without touching GL, in pages carved out of its own linear arena. Any
+// thread can fill one as long as no other thread uses it at the same time, the GL thread merges them into a
+// RenderQueue. Packets stay where they are until reset, so the queue sorts pointers to them instead of copying.
+// Keep one per thread. The members every submit writes are padded onto their own cache lines, so neighbours in an
+// array don't slow each other down.
+class CommandBuffer {
+public:
+    struct Packet {
+        uint64_t key; // RenderQueue::makeKey
+        DrawCommand command;
+    };
+
+    struct Page {
+        static const unsigned int PACKETS = 64;
+
+        Page* next;
+        unsigned int count;
+        Packet packets[PACKETS];
+    };
+
+    explicit CommandBuffer(size_t arenaBlockSize = 64 * 1024);
+
+    void submit(const DrawCommand &command, uint64_t key);
+
+    // Forgets every packet, the memory is kept for the next frame. Not while a queue still holds them
+    void reset();
+
+    size_t size() const;
+
+    const Page* firstPage() const;
+
+private:
+    CachePadding<> leadingPadding;
+    LinearArena arena;
+    Page* first = nullptr;
+    Page* last = nullptr;
+    size_t count = 0;
+    CachePadding<> trailingPadding;
+};
+
+#endif //LEARNOPENGL_COMMANDBUFFER_H
@@ -0,0 +1,70 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+
+FramePacer::FramePacer(int framesInFlight) {
+    setFramesInFlight(framesInFlight);
+}
+
+FramePacer::~FramePacer() {
+    for (GLsync fence : fences) {
+        if (fence != nullptr) glDeleteSync(fence);
+    }
+}
+
+void FramePacer::setFramesInFlight(int frames) {
+    framesInFlight = std::min(std::max(frames, 1), MAX_FRAMES_IN_FLIGHT);
+}
+
+int FramePacer::getFramesInFlight() const {
+    return framesInFlight;
+}
+
+void FramePacer::beginFrame() {
+    lastWaitMilliseconds = 0.0;
+    stats.frames++;
+
+    // The GPU finishes frames in order, so once frame - framesInFlight is done every frame before it is too
+    if (frame < (uint64_t)framesInFlight) return;
+    uint64_t target = frame - framesInFlight;
+
+    auto start = std::chrono::steady_clock::now();
+    bool waited = false;
+    for (; oldestFenced <= target; oldestFenced++) {
+        GLsync &fence = fences[oldestFenced % MAX_FRAMES_IN_FLIGHT];
+        if (fence == nullptr) continue;
+
+        if (oldestFenced == target && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            // Flush on the first wait so the fence actually reaches the GPU, then keep waiting in 1 ms steps
+            waited = true;
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED) flags = 0;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (waited) {
+        lastWaitMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.waitedFrames++;
+        stats.waitMilliseconds += lastWaitMilliseconds;
+        stats.maxWaitMilliseconds = std::max(stats.maxWaitMilliseconds, lastWaitMilliseconds);
+    }
+}
+
+void FramePacer::endFrame() {
+    GLsync &fence = fences[frame % MAX_FRAMES_IN_FLIGHT];
+    if (fence != nullptr) glDeleteSync(fence); // Only when a beginFrame was skipped, that frame is long done
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame++;
+}
+
+double FramePacer::getLastWaitMilliseconds() const {
+    return lastWaitMilliseconds;
+}
+
+FramePacer::Stats FramePacer::takeStats() {
+    Stats taken = stats;
+    stats = {0, 0, 0.0, 0.0};
+    return taken;
+}
@@ -0,0 +1,56 @@
+#ifndef LEARNOPENGL_FRAMEPACER_H
+#define LEARNOPENGL_FRAMEPACER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+// Bounds how far the CPU runs ahead of the GPU instead of leaving it to the driver. Every frame ends with a fence,
+// and before starting frame N the CPU waits for the fence of frame N - framesInFlight. One frame in flight is the
+// lowest latency (the CPU waits for the GPU every frame), three gives the most overlap. How long those waits take
+// tells GPU bound frames (long waits) from CPU bound ones (no waits).
+class FramePacer {
+public:
+    static const int MAX_FRAMES_IN_FLIGHT = 3;
+
+    struct Stats {
+        unsigned int frames;
+        unsigned int waitedFrames; // Frames where the GPU wasn't done yet
+        double waitMilliseconds; // Total
+        double maxWaitMilliseconds;
+    };
+
+    explicit FramePacer(int framesInFlight = 2);
+
+    ~FramePacer();
+
+    FramePacer(const FramePacer &) = delete;
+
+    FramePacer &operator=(const FramePacer &) = delete;
+
+    // Clamped to 1..MAX_FRAMES_IN_FLIGHT, takes effect at the next beginFrame
+    void setFramesInFlight(int frames);
+
+    int getFramesInFlight() const;
+
+    // Before the frame writes anything the GPU may still be reading from, blocks until the GPU has caught up enough
+    void beginFrame();
+
+    // After the frame's last GL call, swap included
+    void endFrame();
+
+    // How long the last beginFrame waited
+    double getLastWaitMilliseconds() const;
+
+    // Since the last call
+    Stats takeStats();
+
+private:
+    int framesInFlight;
+    uint64_t frame = 0; // Frames ended so far
+    uint64_t oldestFenced = 0; // Frames before this one are known to be done
+    GLsync fences[MAX_FRAMES_IN_FLIGHT] = {}; // Frame f in slot f % MAX_FRAMES_IN_FLIGHT
+    double lastWaitMilliseconds = 0.0;
+    Stats stats = {0, 0, 0.0, 0.0};
+};
+
+#endif //LEARNOPENGL_FRAMEPACER_H
@@ -0,0 +1,57 @@
+#include "GLExtensions.h"
+#include <cstring>
+
+bool GLExtensions::programBinary = false;
+bool GLExtensions::parallelShaderCompile = false;
+bool GLExtensions::bufferStorage = false;
+
+PFNGLGETPROGRAMBINARYEXTPROC GLExtensions::getProgramBinary = nullptr;
+PFNGLPROGRAMBINARYEXTPROC GLExtensions::programBinaryLoad = nullptr;
+PFNGLPROGRAMPARAMETERIEXTPROC GLExtensions::programParameteri = nullptr;
+PFNGLMAXSHADERCOMPILERTHREADSEXTPROC GLExtensions::maxShaderCompilerThreads = nullptr;
+PFNGLBUFFERSTORAGEEXTPROC GLExtensions::bufferStorageCreate = nullptr;
+
+void GLExtensions::load(GLADloadproc loader) {
+    // Program binaries -----------
+    if (versionAtLeast(4, 1) || has("GL_ARB_get_program_binary")) {
+        getProgramBinary = (PFNGLGETPROGRAMBINARYEXTPROC)loader("glGetProgramBinary");
+        programBinaryLoad = (PFNGLPROGRAMBINARYEXTPROC)loader("glProgramBinary");
+        programParameteri = (PFNGLPROGRAMPARAMETERIEXTPROC)loader("glProgramParameteri");
+
+        int formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        // Some drivers expose the entry points but no format, that means binaries can't be saved
+        programBinary = getProgramBinary && programBinaryLoad && programParameteri && formats > 0;
+    }
+
+    // Parallel shader compile -----------
+    if (has("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSEXTPROC)loader("glMaxShaderCompilerThreadsKHR");
+    } else if (has("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSEXTPROC)loader("glMaxShaderCompilerThreadsARB");
+    }
+    if (maxShaderCompilerThreads) {
+        maxShaderCompilerThreads(0xFFFFFFFF); // Let the driver pick how many threads it wants
+        parallelShaderCompile = true;
+    }
+
+    // Buffer storage -----------
+    if (versionAtLeast(4, 4) || has("GL_ARB_buffer_storage")) {
+        bufferStorageCreate = (PFNGLBUFFERSTORAGEEXTPROC)loader("glBufferStorage");
+        bufferStorage = bufferStorageCreate != nullptr;
+    }
+}
+
+bool GLExtensions::has(const char *extensionName) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++) {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (name != nullptr && strcmp(name, extensionName) == 0) return true;
+    }
+    return false;
+}
+
+bool GLExtensions::versionAtLeast(int major, int minor) {
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
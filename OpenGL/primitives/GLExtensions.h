@@ -0,0 +1,57 @@
+#ifndef LEARNOPENGL_GLEXTENSIONS_H
+#define LEARNOPENGL_GLEXTENSIONS_H
+
+#include <glad/glad.h>
+
+// Our glad loader only covers 3.3 core, anything newer is declared and loaded here by hand.
+
+// GL_ARB_get_program_binary (core in 4.1)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+// GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+
+// GL_ARB_buffer_storage (core in 4.4)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEEXTPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSEXTPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYEXTPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYEXTPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIEXTPROC)(GLuint program, GLenum pname, GLint value);
+
+class GLExtensions {
+public:
+    // Has to be called once after gladLoadGLLoader with the same loader
+    static void load(GLADloadproc loader);
+
+    static bool has(const char* extensionName);
+
+    static bool programBinary; // GL_ARB_get_program_binary, with at least one binary format
+    static bool parallelShaderCompile; // GL_COMPLETION_STATUS_KHR can be polled without blocking
+    static bool bufferStorage; // Immutable storage, which allows persistent mapping
+
+    static PFNGLGETPROGRAMBINARYEXTPROC getProgramBinary;
+    static PFNGLPROGRAMBINARYEXTPROC programBinaryLoad;
+    static PFNGLPROGRAMPARAMETERIEXTPROC programParameteri;
+    static PFNGLMAXSHADERCOMPILERTHREADSEXTPROC maxShaderCompilerThreads;
+    static PFNGLBUFFERSTORAGEEXTPROC bufferStorageCreate;
+
+private:
+    static bool versionAtLeast(int major, int minor);
+};
+
+#endif //LEARNOPENGL_GLEXTENSIONS_H
@@ -0,0 +1,191 @@
+#include "GLState.h"
+
+unsigned int GLState::program = GLState::UNKNOWN;
+unsigned int GLState::vertexArray = GLState::UNKNOWN;
+unsigned int GLState::buffers[GLState::BUFFER_TARGETS];
+GLState::UniformBinding GLState::uniformBindings[GLState::UNIFORM_BINDINGS];
+unsigned int GLState::textures[GLState::TEXTURE_UNITS][GLState::TEXTURE_TARGETS];
+unsigned int GLState::activeTexture = GLState::UNKNOWN;
+int GLState::blend = -1;
+int GLState::depthTest = -1;
+int GLState::depthMask = -1;
+GLenum GLState::blendSource = GL_NONE;
+GLenum GLState::blendDestination = GL_NONE;
+GLenum GLState::depthFunc = GL_NONE;
+int GLState::viewport[4];
+bool GLState::viewportKnown = false;
+GLState::Stats GLState::stats = {0, 0};
+
+// Static arrays start out zeroed, which would mean "object 0 is bound". Make sure they start unknown instead.
+static const bool initialized = (GLState::invalidate(), true);
+
+bool GLState::changed(bool differs) {
+    if (differs) stats.calls++;
+    else stats.filtered++;
+    return differs;
+}
+
+void GLState::useProgram(unsigned int newProgram) {
+    if (!changed(program != newProgram)) return;
+    program = newProgram;
+    glUseProgram(newProgram);
+}
+
+void GLState::bindVertexArray(unsigned int newVertexArray) {
+    if (!changed(vertexArray != newVertexArray)) return;
+    vertexArray = newVertexArray;
+    glBindVertexArray(newVertexArray);
+
+    // The element buffer binding is part of the VAO, we don't know what the new one has
+    buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+}
+
+void GLState::bindBuffer(GLenum target, unsigned int buffer) {
+    int slot = bufferSlot(target);
+    if (slot == -1) { // Not a target we track, just pass it on
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (!changed(buffers[slot] != buffer)) return;
+    buffers[slot] = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GLState::bindUniformBuffer(unsigned int bindingPoint, unsigned int buffer, GLintptr offset, GLsizeiptr size) {
+    if (bindingPoint < UNIFORM_BINDINGS) {
+        UniformBinding &binding = uniformBindings[bindingPoint];
+        if (!changed(binding.buffer != buffer || binding.offset != offset || binding.size != size)) return;
+        binding = {buffer, offset, size};
+    }
+
+    if (size == 0) glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer);
+    else glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, buffer, offset, size);
+    // Both calls also bind the buffer to the generic GL_UNIFORM_BUFFER target, a filtered call above doesn't
+    buffers[bufferSlot(GL_UNIFORM_BUFFER)] = buffer;
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, unsigned int texture) {
+    int slot = textureSlot(target);
+    if (unit >= TEXTURE_UNITS || slot == -1) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        activeTexture = unit;
+        return;
+    }
+
+    if (!changed(textures[unit][slot] != texture)) return;
+    textures[unit][slot] = texture;
+
+    if (activeTexture != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeTexture = unit;
+    }
+    glBindTexture(target, texture);
+}
+
+void GLState::setBlend(bool enabled) {
+    if (!changed(blend != (int)enabled)) return;
+    blend = enabled;
+    if (enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+}
+
+void GLState::setBlendFunc(GLenum source, GLenum destination) {
+    if (!changed(blendSource != source || blendDestination != destination)) return;
+    blendSource = source;
+    blendDestination = destination;
+    glBlendFunc(source, destination);
+}
+
+void GLState::setDepthTest(bool enabled) {
+    if (!changed(depthTest != (int)enabled)) return;
+    depthTest = enabled;
+    if (enabled) glEnable(GL_DEPTH_TEST);
+    else glDisable(GL_DEPTH_TEST);
+}
+
+void GLState::setDepthFunc(GLenum function) {
+    if (!changed(depthFunc != function)) return;
+    depthFunc = function;
+    glDepthFunc(function);
+}
+
+void GLState::setDepthMask(bool write) {
+    if (!changed(depthMask != (int)write)) return;
+    depthMask = write;
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::setViewport(int x, int y, int width, int height) {
+    bool same = viewportKnown && viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height;
+    if (!changed(!same)) return;
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = width;
+    viewport[3] = height;
+    viewportKnown = true;
+    glViewport(x, y, width, height);
+}
+
+void GLState::forgetProgram(unsigned int deleted) {
+    if (program == deleted) program = UNKNOWN;
+}
+
+void GLState::forgetVertexArray(unsigned int deleted) {
+    if (vertexArray == deleted) vertexArray = UNKNOWN;
+    buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+}
+
+void GLState::forgetBuffer(unsigned int deleted) {
+    for (unsigned int &buffer : buffers) {
+        if (buffer == deleted) buffer = UNKNOWN;
+    }
+    for (UniformBinding &binding : uniformBindings) {
+        if (binding.buffer == deleted) binding.buffer = UNKNOWN;
+    }
+}
+
+void GLState::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    for (unsigned int &buffer : buffers) buffer = UNKNOWN;
+    for (UniformBinding &binding : uniformBindings) binding = {UNKNOWN, 0, 0};
+    for (auto &unit : textures) {
+        for (unsigned int &texture : unit) texture = UNKNOWN;
+    }
+    activeTexture = UNKNOWN;
+    blend = depthTest = depthMask = -1;
+    blendSource = blendDestination = depthFunc = GL_NONE;
+    viewportKnown = false;
+}
+
+GLState::Stats GLState::endFrame() {
+    Stats frame = stats;
+    stats = {0, 0};
+    return frame;
+}
+
+const GLState::Stats &GLState::frameStats() {
+    return stats;
+}
+
+int GLState::bufferSlot(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_COPY_READ_BUFFER: return 3;
+        case GL_COPY_WRITE_BUFFER: return 4;
+        default: return -1;
+    }
+}
+
+int GLState::textureSlot(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_3D: return 1;
+        case GL_TEXTURE_CUBE_MAP: return 2;
+        default: return -1;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef LEARNOPENGL_GLSTATE_H
+#define LEARNOPENGL_GLSTATE_H
+
+#include <glad/glad.h>
+
+// Shadow copy of the GL state we touch. Every call goes through here and is dropped when it wouldn't change anything,
+// so code can say what it needs for a draw without caring what was bound before.
+// Only valid if nobody changes this state behind its back, if something has to, call invalidate() afterwards.
+class GLState {
+public:
+    struct Stats {
+        unsigned int calls; // Calls that reached the driver
+        unsigned int filtered; // Calls that were dropped because the state was already set
+    };
+
+    static void useProgram(unsigned int program);
+
+    static void bindVertexArray(unsigned int vertexArray);
+
+    // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_COPY_READ/WRITE_BUFFER
+    static void bindBuffer(GLenum target, unsigned int buffer);
+
+    // Indexed uniform buffer bindings, size 0 means the whole buffer (glBindBufferBase)
+    static void bindUniformBuffer(unsigned int bindingPoint, unsigned int buffer, GLintptr offset = 0,
+                                  GLsizeiptr size = 0);
+
+    static void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+
+    static void setBlend(bool enabled);
+
+    static void setBlendFunc(GLenum source, GLenum destination);
+
+    static void setDepthTest(bool enabled);
+
+    static void setDepthFunc(GLenum function);
+
+    static void setDepthMask(bool write);
+
+    static void setViewport(int x, int y, int width, int height);
+
+    // Objects that get deleted have to be forgotten, GL reuses their names
+    static void forgetProgram(unsigned int program);
+
+    static void forgetVertexArray(unsigned int vertexArray);
+
+    static void forgetBuffer(unsigned int buffer);
+
+    // Forget everything, the next call of each kind always reaches the driver
+    static void invalidate();
+
+    // Returns the counters of the frame that just ended and starts a new one
+    static Stats endFrame();
+
+    static const Stats &frameStats();
+
+private:
+    static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+    static const int BUFFER_TARGETS = 5;
+    static const int UNIFORM_BINDINGS = 36;
+    static const int TEXTURE_UNITS = 16;
+    static const int TEXTURE_TARGETS = 3; // 2D, 3D, cube map
+
+    struct UniformBinding {
+        unsigned int buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    static unsigned int program;
+    static unsigned int vertexArray;
+    static unsigned int buffers[BUFFER_TARGETS];
+    static UniformBinding uniformBindings[UNIFORM_BINDINGS];
+    static unsigned int textures[TEXTURE_UNITS][TEXTURE_TARGETS];
+    static unsigned int activeTexture;
+    static int blend, depthTest, depthMask; // -1 unknown
+    static GLenum blendSource, blendDestination, depthFunc;
+    static int viewport[4];
+    static bool viewportKnown;
+
+    static Stats stats;
+
+    static int bufferSlot(GLenum target);
+
+    static int textureSlot(GLenum target);
+
+    static bool changed(bool differs);
+};
+
+#endif //LEARNOPENGL_GLSTATE_H
@@ -0,0 +1,56 @@
+#include "GeometryArena.h"
+#include "GLState.h"
+
+GeometryArena::GeometryArena(const VertexFormat &format, unsigned int vertexCapacity, unsigned int indexCapacity,
+                             GLenum indexType)
+        : format(format), indexType(indexType), vertices(format.getStride(), vertexCapacity),
+          indices(indexType == GL_UNSIGNED_SHORT ? 2 : 4, indexCapacity) {}
+
+GeometryArena::~GeometryArena() {
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        GLState::forgetVertexArray(VAO);
+    }
+}
+
+unsigned int GeometryArena::prepare(const Shader &shader) {
+    if (VAO != 0 && preparedProgram == shader.ID && preparedRevision == shader.getRevision()) return VAO;
+
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        GLState::forgetVertexArray(VAO);
+    }
+    glGenVertexArrays(1, &VAO);
+    GLState::bindVertexArray(VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vertices.getID());
+    format.resolve(shader).apply();
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.getID());
+
+    preparedProgram = shader.ID;
+    preparedRevision = shader.getRevision();
+    return VAO;
+}
+
+size_t GeometryArena::defragment() {
+    return vertices.defragment() + indices.defragment();
+}
+
+BufferArena &GeometryArena::getVertices() {
+    return vertices;
+}
+
+BufferArena &GeometryArena::getIndices() {
+    return indices;
+}
+
+const VertexFormat &GeometryArena::getFormat() const {
+    return format;
+}
+
+GLenum GeometryArena::getIndexType() const {
+    return indexType;
+}
+
+unsigned int GeometryArena::getVertexArray() const {
+    return VAO;
+}
@@ -0,0 +1,49 @@
+#ifndef LEARNOPENGL_GEOMETRYARENA_H
+#define LEARNOPENGL_GEOMETRYARENA_H
+
+#include <glad/glad.h>
+#include "BufferArena.h"
+#include "VertexFormat.h"
+#include "Shader.h"
+
+// A vertex arena and an index arena for meshes of one vertex format, plus the single VAO that reads them. Every mesh
+// placed here (see Mesh(GeometryArena&)) draws from the same VAO with its own base vertex and first index, so going
+// from one mesh to the next costs no buffer or VAO binds at all.
+class GeometryArena {
+public:
+    GeometryArena(const VertexFormat &format, unsigned int vertexCapacity, unsigned int indexCapacity,
+                  GLenum indexType = GL_UNSIGNED_SHORT);
+
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena &) = delete;
+
+    GeometryArena &operator=(const GeometryArena &) = delete;
+
+    // Same as Mesh::prepare, the VAO follows the inputs of the last shader and is rebuilt when it relinks
+    unsigned int prepare(const Shader &shader);
+
+    // Compacts both arenas. Meshes look their offsets up when drawn, so nothing else has to change
+    size_t defragment();
+
+    BufferArena &getVertices();
+
+    BufferArena &getIndices();
+
+    const VertexFormat &getFormat() const;
+
+    GLenum getIndexType() const;
+
+    unsigned int getVertexArray() const;
+
+private:
+    VertexFormat format;
+    GLenum indexType;
+    BufferArena vertices;
+    BufferArena indices;
+    unsigned int VAO = 0;
+    unsigned int preparedProgram = 0;
+    int preparedRevision = 0;
+};
+
+#endif //LEARNOPENGL_GEOMETRYARENA_H
@@ -0,0 +1,80 @@
+#ifndef LEARNOPENGL_INSTANCEBUFFER_H
+#define LEARNOPENGL_INSTANCEBUFFER_H
+
+#include <glad/glad.h>
+#include <iostream>
+#include "StreamBuffer.h"
+
+// Per instance attributes (offset, color...) for instanced draws, pair it with a VertexFormat marked perInstance()
+// that describes T. Every frame: clear, push the instances (they go straight into GPU visible memory), upload before
+// drawing and fence once the draws are issued. Each frame lands in the next partition of a ring, so the attribute
+// pointers need getOffset(), usually one VAO per partition.
+template <typename T>
+class InstanceBuffer {
+public:
+    static const int PARTITIONS = 3;
+
+    explicit InstanceBuffer(size_t capacity) : stream(GL_ARRAY_BUFFER, capacity * sizeof(T), PARTITIONS),
+                                               capacity(capacity) {}
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer &operator=(const InstanceBuffer&) = delete;
+
+    // Starts the instances of a new frame
+    void clear() {
+        if (instances != nullptr) upload();
+        instances = (T*)stream.begin();
+        count = 0;
+    }
+
+    void push(const T &instance) {
+        if (instances == nullptr) clear();
+        if (count == capacity) {
+            std::cout << "ERROR::INSTANCE_BUFFER::FULL capacity " << capacity << std::endl;
+            return;
+        }
+        instances[count++] = instance;
+    }
+
+    // Done writing, the instances can be drawn now
+    void upload() {
+        if (instances == nullptr) return;
+        stream.end();
+        instances = nullptr;
+    }
+
+    // Call after the draws using this frame's instances
+    void fence() {
+        stream.fence();
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    unsigned int getID() const {
+        return stream.getID();
+    }
+
+    // Byte offset of this frame's instances in the buffer
+    size_t getOffset() const {
+        return stream.getOffset();
+    }
+
+    // Which of the PARTITIONS this frame writes, handy to index per partition VAOs
+    int getPartition() const {
+        return stream.getPartition() < 0 ? 0 : stream.getPartition();
+    }
+
+    StreamBuffer &getStream() {
+        return stream;
+    }
+
+private:
+    StreamBuffer stream;
+    size_t capacity;
+    size_t count = 0;
+    T* instances = nullptr; // Mapped memory of the current partition while writing
+};
+
+#endif //LEARNOPENGL_INSTANCEBUFFER_H
@@ -0,0 +1,68 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return;
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0) {
+        if (info.st_size == 0) {
+            bytes = "";
+        } else {
+            void* memory = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (memory != MAP_FAILED) {
+                bytes = (const char*)memory;
+                length = (size_t)info.st_size;
+                mapped = true;
+            }
+        }
+    }
+
+    close(fd); // The mapping keeps its own reference to the file
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept : bytes(other.bytes), length(other.length), mapped(other.mapped) {
+    other.bytes = nullptr;
+    other.length = 0;
+    other.mapped = false;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        bytes = other.bytes;
+        length = other.length;
+        mapped = other.mapped;
+        other.bytes = nullptr;
+        other.length = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+void MappedFile::unmap() {
+    if (mapped) munmap((void*)bytes, length);
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+bool MappedFile::isOpen() const {
+    return bytes != nullptr;
+}
+
+const char *MappedFile::data() const {
+    return bytes;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,37 @@
+#ifndef LEARNOPENGL_MAPPEDFILE_H
+#define LEARNOPENGL_MAPPEDFILE_H
+
+#include <cstddef>
+
+// Read only memory mapping of a whole file. The bytes stay valid (and at the same address) until the object dies,
+// moving it around is fine.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const char* path);
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    bool isOpen() const;
+
+    const char* data() const;
+
+    size_t size() const;
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false; // Empty files are open but have nothing mapped
+
+    void unmap();
+};
+
+#endif //LEARNOPENGL_MAPPEDFILE_H
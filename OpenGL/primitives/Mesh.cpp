@@ -0,0 +1,228 @@
+#include "Mesh.h"
+#include "GLState.h"
+#include "../geometry/MeshOptimizer.h"
+#include <iostream>
+#include <utility>
+
+Mesh::Mesh(const VertexFormat &format) : format(format) {}
+
+Mesh::Mesh(GeometryArena &arena) : format(arena.getFormat()), indexType(arena.getIndexType()), arena(&arena) {}
+
+Mesh::~Mesh() {
+    release();
+}
+
+Mesh::Mesh(Mesh &&other) noexcept
+        : format(std::move(other.format)), VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), indexType(other.indexType),
+          vertexCount(other.vertexCount), indexCount(other.indexCount), subMeshes(std::move(other.subMeshes)),
+          stagedVertices(std::move(other.stagedVertices)), stagedIndices(std::move(other.stagedIndices)),
+          preparedProgram(other.preparedProgram), preparedRevision(other.preparedRevision), arena(other.arena),
+          vertexRange(other.vertexRange), indexRange(other.indexRange) {
+    other.VAO = other.VBO = other.EBO = 0;
+    other.vertexRange = other.indexRange = RangeAllocator::INVALID;
+    other.vertexCount = other.indexCount = 0;
+}
+
+Mesh &Mesh::operator=(Mesh &&other) noexcept {
+    if (this != &other) {
+        release();
+        format = std::move(other.format);
+        VAO = other.VAO;
+        VBO = other.VBO;
+        EBO = other.EBO;
+        indexType = other.indexType;
+        vertexCount = other.vertexCount;
+        indexCount = other.indexCount;
+        subMeshes = std::move(other.subMeshes);
+        stagedVertices = std::move(other.stagedVertices);
+        stagedIndices = std::move(other.stagedIndices);
+        preparedProgram = other.preparedProgram;
+        preparedRevision = other.preparedRevision;
+        arena = other.arena;
+        vertexRange = other.vertexRange;
+        indexRange = other.indexRange;
+        other.VAO = other.VBO = other.EBO = 0;
+        other.vertexRange = other.indexRange = RangeAllocator::INVALID;
+        other.vertexCount = other.indexCount = 0;
+    }
+    return *this;
+}
+
+unsigned int Mesh::add(const std::vector<unsigned char> &vertices, const std::vector<unsigned int> &indices) {
+    if (isUploaded()) {
+        std::cout << "ERROR::MESH::ADD sub-meshes have to be added before upload" << std::endl;
+        return 0;
+    }
+
+    unsigned int stride = format.getStride();
+    SubMesh subMesh;
+    subMesh.firstIndex = indexCount + (unsigned int)stagedIndices.size();
+    subMesh.indexCount = (unsigned int)indices.size();
+    subMesh.baseVertex = (int)(vertexCount + stagedVertices.size() / stride);
+    subMesh.vertexCount = (unsigned int)(vertices.size() / stride);
+
+    stagedVertices.insert(stagedVertices.end(), vertices.begin(), vertices.end());
+    stagedIndices.insert(stagedIndices.end(), indices.begin(), indices.end());
+    subMeshes.push_back(subMesh);
+    return (unsigned int)subMeshes.size() - 1;
+}
+
+void Mesh::upload() {
+    if (isUploaded() || stagedVertices.empty()) return;
+
+    // Indices are local to their sub-mesh, so the biggest sub-mesh decides if 16 bits are enough
+    unsigned int size = 2;
+    for (const SubMesh &subMesh : subMeshes) {
+        if (MeshOptimizer::indexSize(subMesh.vertexCount) > size) size = MeshOptimizer::indexSize(subMesh.vertexCount);
+    }
+    if (arena != nullptr && size > indexSize()) {
+        std::cout << "ERROR::MESH::UPLOAD a sub-mesh has too many vertices for the arena's 16 bit indices" << std::endl;
+        return;
+    }
+    if (arena == nullptr) indexType = size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    std::vector<unsigned char> indexData = MeshOptimizer::packIndices(stagedIndices.data(), stagedIndices.size(),
+                                                                      indexSize());
+
+    unsigned int stagedVertexCount = (unsigned int)(stagedVertices.size() / format.getStride());
+    unsigned int stagedIndexCount = (unsigned int)stagedIndices.size();
+
+    if (arena != nullptr) {
+        // Both ranges or neither, a mesh with only one of them can't draw
+        vertexRange = arena->getVertices().allocate(stagedVertexCount);
+        indexRange = arena->getIndices().allocate(stagedIndexCount);
+        if (vertexRange == RangeAllocator::INVALID || indexRange == RangeAllocator::INVALID) {
+            std::cout << "ERROR::MESH::UPLOAD the geometry arena is full" << std::endl;
+            release();
+            return;
+        }
+        arena->getVertices().write(vertexRange, stagedVertices.data(), stagedVertexCount);
+        arena->getIndices().write(indexRange, indexData.data(), stagedIndexCount);
+    } else {
+        uploadBuffers(indexData);
+    }
+
+    vertexCount = stagedVertexCount;
+    indexCount = stagedIndexCount;
+    std::vector<unsigned char>().swap(stagedVertices);
+    std::vector<unsigned int>().swap(stagedIndices);
+}
+
+void Mesh::uploadBuffers(const std::vector<unsigned char> &indexData) {
+    glGenBuffers(1, &VBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, stagedVertices.size(), stagedVertices.data(), GL_STATIC_DRAW);
+
+    // Through the copy target, GL_ELEMENT_ARRAY_BUFFER belongs to whatever VAO is bound
+    glGenBuffers(1, &EBO);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexData.size(), indexData.data(), GL_STATIC_DRAW);
+}
+
+unsigned int Mesh::prepare(const Shader &shader) {
+    if (!isUploaded()) return 0;
+    if (arena != nullptr) return arena->prepare(shader);
+    if (VAO != 0 && preparedProgram == shader.ID && preparedRevision == shader.getRevision()) return VAO;
+
+    // A fresh VAO rather than patching the old one, attributes the new program doesn't use must not stay enabled
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        GLState::forgetVertexArray(VAO);
+    }
+    glGenVertexArrays(1, &VAO);
+    GLState::bindVertexArray(VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    format.resolve(shader).apply();
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    preparedProgram = shader.ID;
+    preparedRevision = shader.getRevision();
+    return VAO;
+}
+
+void Mesh::draw(unsigned int subMesh, GLenum mode) const {
+    const SubMesh &range = subMeshes[subMesh];
+    GLState::bindVertexArray(getVertexArray());
+    glDrawElementsBaseVertex(mode, range.indexCount, indexType,
+                             (void*)(size_t)((firstIndex() + range.firstIndex) * indexSize()),
+                             firstVertex() + range.baseVertex);
+}
+
+void Mesh::fill(DrawCommand &command, unsigned int subMesh) const {
+    const SubMesh &range = subMeshes[subMesh];
+    command.vertexArray = getVertexArray();
+    command.indexType = indexType;
+    command.count = (int)range.indexCount;
+    command.indexOffset = (firstIndex() + range.firstIndex) * indexSize();
+    command.baseVertex = firstVertex() + range.baseVertex;
+}
+
+const Mesh::SubMesh &Mesh::getSubMesh(unsigned int subMesh) const {
+    return subMeshes[subMesh];
+}
+
+size_t Mesh::getSubMeshCount() const {
+    return subMeshes.size();
+}
+
+const VertexFormat &Mesh::getFormat() const {
+    return format;
+}
+
+unsigned int Mesh::getVertexArray() const {
+    return arena != nullptr ? arena->getVertexArray() : VAO;
+}
+
+unsigned int Mesh::getVertexBuffer() const {
+    return arena != nullptr ? arena->getVertices().getID() : VBO;
+}
+
+unsigned int Mesh::getIndexBuffer() const {
+    return arena != nullptr ? arena->getIndices().getID() : EBO;
+}
+
+GLenum Mesh::getIndexType() const {
+    return indexType;
+}
+
+unsigned int Mesh::getIndexCount() const {
+    return indexCount;
+}
+
+unsigned int Mesh::getVertexCount() const {
+    return vertexCount;
+}
+
+void Mesh::release() {
+    if (arena != nullptr) {
+        if (vertexRange != RangeAllocator::INVALID) arena->getVertices().free(vertexRange);
+        if (indexRange != RangeAllocator::INVALID) arena->getIndices().free(indexRange);
+        vertexRange = indexRange = RangeAllocator::INVALID;
+    }
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        GLState::forgetVertexArray(VAO);
+    }
+    unsigned int buffers[] = {VBO, EBO};
+    for (unsigned int buffer : buffers) {
+        if (buffer == 0) continue;
+        glDeleteBuffers(1, &buffer);
+        GLState::forgetBuffer(buffer);
+    }
+    VAO = VBO = EBO = 0;
+}
+
+unsigned int Mesh::indexSize() const {
+    return indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+bool Mesh::isUploaded() const {
+    return VBO != 0 || vertexRange != RangeAllocator::INVALID;
+}
+
+int Mesh::firstVertex() const {
+    return arena != nullptr && vertexRange != RangeAllocator::INVALID ? (int)arena->getVertices().offsetOf(vertexRange) : 0;
+}
+
+unsigned int Mesh::firstIndex() const {
+    return arena != nullptr && indexRange != RangeAllocator::INVALID ? arena->getIndices().offsetOf(indexRange) : 0;
+}
@@ -0,0 +1,110 @@
+#ifndef LEARNOPENGL_MESH_H
+#define LEARNOPENGL_MESH_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "VertexFormat.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "GeometryArena.h"
+
+// Owns a vertex buffer, an index buffer and the VAO reading them, and deletes them when it goes away.
+// One Mesh can hold many sub-meshes, each a range of indices into the shared buffers. Their indices stay relative to
+// their own first vertex and are drawn with glDrawElementsBaseVertex, so a whole scene can be drawn out of one VAO
+// without rebinding buffers, and 16 bit indices are enough while every sub-mesh is under 65535 vertices.
+// A Mesh made from a GeometryArena owns ranges of the arena's buffers instead, and gives them back when it goes away.
+class Mesh {
+public:
+    struct SubMesh {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        int baseVertex;
+        unsigned int vertexCount;
+    };
+
+    explicit Mesh(const VertexFormat &format);
+
+    // Lives in the arena's buffers and draws with its VAO, the arena must outlive the mesh
+    explicit Mesh(GeometryArena &arena);
+
+    ~Mesh();
+
+    Mesh(Mesh &&other) noexcept;
+
+    Mesh &operator=(Mesh &&other) noexcept;
+
+    Mesh(const Mesh &) = delete;
+
+    Mesh &operator=(const Mesh &) = delete;
+
+    // Stages a sub-mesh and returns its index. The vertices are already in the mesh's format (VertexFormat::pack),
+    // the indices count from its first vertex. Nothing reaches GL until upload
+    unsigned int add(const std::vector<unsigned char> &vertices, const std::vector<unsigned int> &indices);
+
+    // Creates the buffers out of everything added so far and drops the CPU copies
+    void upload();
+
+    // The VAO follows the inputs of the shader it was last prepared for and is rebuilt when that shader relinks.
+    // Returns it, 0 if nothing was uploaded yet. Drawing one mesh with several programs goes through VertexArrayCache
+    unsigned int prepare(const Shader &shader);
+
+    // Draws a sub-mesh right away with the current program
+    void draw(unsigned int subMesh, GLenum mode = GL_TRIANGLES) const;
+
+    // Fills in the geometry part of a draw command for a sub-mesh: VAO, index type, count, offset and base vertex
+    void fill(DrawCommand &command, unsigned int subMesh) const;
+
+    const SubMesh &getSubMesh(unsigned int subMesh) const;
+
+    size_t getSubMeshCount() const;
+
+    const VertexFormat &getFormat() const;
+
+    unsigned int getVertexArray() const;
+
+    unsigned int getVertexBuffer() const;
+
+    unsigned int getIndexBuffer() const;
+
+    GLenum getIndexType() const;
+
+    unsigned int getIndexCount() const;
+
+    unsigned int getVertexCount() const;
+
+private:
+    VertexFormat format;
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    std::vector<SubMesh> subMeshes;
+
+    // Kept until upload
+    std::vector<unsigned char> stagedVertices;
+    std::vector<unsigned int> stagedIndices;
+
+    unsigned int preparedProgram = 0;
+    int preparedRevision = 0;
+
+    GeometryArena* arena = nullptr;
+    unsigned int vertexRange = RangeAllocator::INVALID;
+    unsigned int indexRange = RangeAllocator::INVALID;
+
+    void release();
+
+    void uploadBuffers(const std::vector<unsigned char> &indexData);
+
+    bool isUploaded() const;
+
+    // Where the mesh starts in its buffers, 0 unless it lives in an arena
+    int firstVertex() const;
+
+    unsigned int firstIndex() const;
+
+    unsigned int indexSize() const;
+};
+
+#endif //LEARNOPENGL_MESH_H
@@ -0,0 +1,122 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+#include <utility>
+
+uint64_t RenderQueue::makeKey(unsigned int layer, unsigned int program, unsigned int vertexArray,
+                              unsigned int material, float depth) {
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    auto quantizedDepth = (uint64_t)(depth * 16777215.0f);
+
+    // IDs wider than their field wrap, that only makes the grouping a bit worse, replay compares the real IDs
+    return ((uint64_t)(layer & 0xF) << 60) | ((uint64_t)(program & 0xFFF) << 48) |
+           ((uint64_t)(vertexArray & 0xFFF) << 36) | ((uint64_t)(material & 0xFFF) << 24) | quantizedDepth;
+}
+
+void RenderQueue::submit(const DrawCommand &command, uint64_t key) {
+    immediate.submit(command, key);
+}
+
+void RenderQueue::merge(const CommandBuffer &buffer) {
+    buffers.push_back(&buffer);
+}
+
+void RenderQueue::flush() {
+    // Gather every packet, the queue's own first then the merged buffers in merge order
+    buffers.insert(buffers.begin(), &immediate);
+    for (const CommandBuffer* buffer : buffers) {
+        for (const CommandBuffer::Page* page = buffer->firstPage(); page; page = page->next) {
+            for (unsigned int i = 0; i < page->count; i++) {
+                entries.push_back({page->packets[i].key, &page->packets[i].command});
+            }
+        }
+    }
+
+    stats.draws = (unsigned int)entries.size();
+    stats.instances = 0;
+    stats.stateChangesSubmitted = countStateChanges(entries);
+
+    radixSort();
+    stats.stateChangesSorted = countStateChanges(entries);
+
+    for (const SortEntry &entry : entries) {
+        const DrawCommand &command = *entry.command;
+
+        // GLState drops whatever is already bound, which after sorting is most of it
+        GLState::useProgram(command.program);
+        GLState::bindVertexArray(command.vertexArray);
+        if (command.texture != 0) GLState::bindTexture(0, GL_TEXTURE_2D, command.texture);
+        if (command.uniformSize != 0) {
+            GLState::bindUniformBuffer(command.uniformBinding, command.uniformBuffer, command.uniformOffset,
+                                       command.uniformSize);
+        }
+
+        if (command.instanceCount > 1) {
+            glDrawElementsInstancedBaseVertex(command.mode, command.count, command.indexType,
+                                              (void*)(size_t)command.indexOffset, command.instanceCount,
+                                              command.baseVertex);
+            stats.instances += command.instanceCount;
+        } else {
+            glDrawElementsBaseVertex(command.mode, command.count, command.indexType, (void*)(size_t)command.indexOffset,
+                                     command.baseVertex);
+            stats.instances++;
+        }
+    }
+
+    immediate.reset();
+    buffers.clear();
+    entries.clear();
+}
+
+const RenderQueue::Stats &RenderQueue::lastStats() const {
+    return stats;
+}
+
+size_t RenderQueue::size() const {
+    size_t count = immediate.size();
+    for (const CommandBuffer* buffer : buffers) count += buffer->size();
+    return count;
+}
+
+void RenderQueue::radixSort() {
+    // LSD radix sort, 8 bits per pass over small {key, index} pairs. Passes where every key has the same byte
+    // (common for the high bits) are skipped.
+    size_t count = entries.size();
+    if (count < 2) return;
+    scratch.resize(count);
+
+    SortEntry* source = entries.data();
+    SortEntry* destination = scratch.data();
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; i++) histogram[(source[i].key >> shift) & 0xFF]++;
+
+        if (histogram[(source[0].key >> shift) & 0xFF] == count) continue; // Nothing to reorder for this byte
+
+        size_t offset = 0;
+        for (size_t &bucket : histogram) {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for (size_t i = 0; i < count; i++) destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+        std::swap(source, destination);
+    }
+
+    if (source != entries.data()) entries.swap(scratch);
+}
+
+unsigned int RenderQueue::countStateChanges(const std::vector<SortEntry> &entries) {
+    unsigned int changes = 0;
+    const DrawCommand* previous = nullptr;
+    for (const SortEntry &entry : entries) {
+        const DrawCommand &command = *entry.command;
+        if (previous == nullptr || previous->program != command.program) changes++;
+        if (previous == nullptr || previous->vertexArray != command.vertexArray) changes++;
+        if (previous == nullptr || previous->texture != command.texture) changes++;
+        previous = &command;
+    }
+    return changes;
+}
@@ -0,0 +1,57 @@
+#ifndef LEARNOPENGL_RENDERQUEUE_H
+#define LEARNOPENGL_RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CommandBuffer.h"
+
+// Draws are submitted in any order with a 64 bit sort key, flush sorts them so draws sharing a program, VAO and
+// material end up next to each other and replays them through GLState. Key layout, most significant first:
+//   layer 4 bits | program 12 bits | VAO 12 bits | material 12 bits | depth 24 bits
+// Draws can also be recorded on other threads into CommandBuffers and merged in, the sort puts them all together.
+class RenderQueue {
+public:
+    struct Stats {
+        unsigned int draws;
+        unsigned int instances; // Objects drawn, instanced draws count each copy
+        unsigned int stateChangesSubmitted; // Program/VAO/texture switches if we drew in submission order
+        unsigned int stateChangesSorted; // Switches after sorting, what actually reaches GL
+    };
+
+    // depth is 0..1, nearer first. Pass 1 - depth for layers that have to draw back to front (transparency)
+    static uint64_t makeKey(unsigned int layer, unsigned int program, unsigned int vertexArray, unsigned int material,
+                            float depth);
+
+    void submit(const DrawCommand &command, uint64_t key);
+
+    // Takes the buffer's draws into the next flush without copying them, leave it alone until then
+    void merge(const CommandBuffer &buffer);
+
+    // Sorts, draws everything and empties the queue. Merged buffers can be reset after this
+    void flush();
+
+    const Stats &lastStats() const;
+
+    size_t size() const;
+
+private:
+    // Same 16 bytes as a key and an index would take with padding
+    struct SortEntry {
+        uint64_t key;
+        const DrawCommand* command;
+    };
+
+    CommandBuffer immediate; // What submit records
+    std::vector<const CommandBuffer*> buffers;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    Stats stats = {0, 0, 0, 0};
+
+    void radixSort();
+
+    static unsigned int countStateChanges(const std::vector<SortEntry> &entries);
+};
+
+#endif //LEARNOPENGL_RENDERQUEUE_H
@@ -3,106 +3,668 @@
 //
 
 #include "Shader.h"
+#include "GLExtensions.h"
+#include "UniformBuffer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+std::string Shader::binaryCacheDirectory;
+
+// Header written in front of every cached program binary
+struct ProgramBinaryHeader {
+    unsigned int magic;
+    unsigned int format;
+    unsigned int length;
+};
+
+static const unsigned int PROGRAM_BINARY_MAGIC = 0x42504C47; // "GLPB"
+
+// FNV-1a, only used to order and find entries in the uniform table
+static unsigned int hashUniformName(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (; *name; name++) {
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+    }
+    return hash;
+}
+
+// 64 bit FNV-1a, used as the program binary cache key
+static unsigned long long hashBytes(unsigned long long hash, const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static unsigned long long hashString(unsigned long long hash, const char* text) {
+    return hashBytes(hash, text != nullptr ? text : "", text != nullptr ? strlen(text) + 1 : 1);
+}
+
+Shader::Shader(const char* shaderPath) : Shader(shaderPath, false) {}
+
+Shader::Shader(const char* shaderPath, bool async) : Shader(shaderPath, std::vector<std::string>(), async) {}
+
+Shader::Shader(const char* shaderPath, const std::vector<std::string> &defines, bool async)
+        : path(shaderPath), defines(defines) {
+    loadStart = std::chrono::steady_clock::now();
+
+    ShaderSourceCode source = parseShader(shaderPath, defines);
+    dependencies = source.dependencies;
+    cachePath = binaryCachePath(source);
+
+    if (loadProgramBinary(cachePath)) {
+        loadedFromCache = true;
+        finishLoad();
+        return;
+    }
 
-Shader::Shader(const char* shaderPath){
-    ShaderSourceCode source = parseShader(shaderPath);
     compileShader(source);
+    if (!async) pollCompile(true);
+}
+
+void Shader::setBinaryCacheDirectory(const std::string &directory) {
+    binaryCacheDirectory = directory;
+    if (!directory.empty()) mkdir(directory.c_str(), 0755); // Fails harmlessly if it already exists
 }
 
 Shader::~Shader() {
+    for (unsigned int stage : stageIDs) glDeleteShader(stage);
     glDeleteProgram(ID);
+    GLState::forgetProgram(ID);
+}
+
+// Helpers for the preprocessor
+static const char* skipBlanks(const char* text, const char* end) {
+    while (text < end && (*text == ' ' || *text == '\t')) text++;
+    return text;
+}
+
+static bool startsWith(const char* text, const char* end, const char* word) {
+    size_t length = strlen(word);
+    return (size_t)(end - text) >= length && memcmp(text, word, length) == 0;
+}
+
+static std::string directoryOf(const std::string &filePath) {
+    size_t slash = filePath.find_last_of('/');
+    return slash == std::string::npos ? "." : filePath.substr(0, slash);
 }
 
-Shader::ShaderSourceCode Shader::parseShader(const char *shaderPath) {
-    // Read shaders from file
-    std::ifstream stream(shaderPath);
+Shader::ShaderSourceCode Shader::parseShader(const char *shaderPath, const std::vector<std::string> &defines,
+                                             bool copy) {
+    ShaderSourceCode source;
 
-    ShaderType type = ShaderType::NONE;
+    const char* data;
+    size_t size;
+    if (!loadFile(source, shaderPath, copy, data, size)) return source;
+    splitStages(source, data, size, shaderPath);
 
-    std::string line;
-    std::stringstream ss[2]; // If I have more shaders in the future I shall increase this
+    // Every stage gets the same #define block
+    std::string defineBlock;
+    for (const std::string &define : defines) {
+        std::string line = define;
+        size_t equals = line.find('=');
+        if (equals != std::string::npos) line[equals] = ' '; // "NAME=VALUE" works too
+        defineBlock += "#define " + line + "\n";
+    }
+    if (!defineBlock.empty()) source.ownedText.emplace_back(defineBlock.begin(), defineBlock.end());
+
+    const char* defineData = defineBlock.empty() ? nullptr : source.ownedText.back().data();
+    std::string directory = directoryOf(shaderPath);
+    for (ShaderStage &stage : source.stages) {
+        preprocessStage(source, stage, defineData, (int)defineBlock.size(), directory, copy);
+    }
+
+    return source;
+}
+
+bool Shader::loadFile(Shader::ShaderSourceCode &source, const std::string &filePath, bool copy, const char *&data,
+                      size_t &size) {
+    bool first = source.dependencies.empty(); // The .shader file itself, includes go to their own storage
+    if (copy) {
+        std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+        if (!stream) {
+            std::cout << "ERROR::SHADER::FILE_NOT_READ " << filePath << std::endl;
+            return false;
+        }
+        std::vector<char> &text = first ? source.text : (source.ownedText.emplace_back(), source.ownedText.back());
+        // One read of the whole file, going through istreambuf_iterator is a char at a time
+        std::streamoff length = stream.tellg();
+        text.resize(length > 0 ? (size_t)length : 0);
+        stream.seekg(0);
+        stream.read(text.data(), (std::streamsize)text.size());
+        text.resize((size_t)stream.gcount());
+        data = text.data();
+        size = text.size();
+    } else {
+        MappedFile file(filePath.c_str());
+        if (!file.isOpen()) {
+            std::cout << "ERROR::SHADER::FILE_NOT_READ " << filePath << std::endl;
+            return false;
+        }
+        data = file.data();
+        size = file.size();
+        if (first) source.file = std::move(file);
+        else source.includedFiles.push_back(std::move(file)); // Moving keeps the mapping where it is
+    }
+
+    source.dependencies.push_back(filePath);
+    return true;
+}
+
+void Shader::splitStages(Shader::ShaderSourceCode &source, const char *data, size_t size, const char *shaderPath) {
+    // Split on "#shader <stage>" lines, every stage starts as a single chunk of data
+    const char* cursor = data;
+    const char* end = data + size;
+    ShaderStage* current = nullptr; // Lines before the first marker don't belong to any stage
+    bool strayLines = false;
+
+    while (cursor < end) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+        const char* next = lineEnd != nullptr ? lineEnd + 1 : end;
+        if (lineEnd == nullptr) lineEnd = end;
 
-    while (getline(stream, line)) {
-        if (line.find("#shader") != std::string::npos) {
-            if(line.find("vertex") != std::string::npos) {
-                type = ShaderType::VERTEX;
-            } else if (line.find("fragment") != std::string::npos) {
-                type = ShaderType::FRAGMENT;
+        const char* text = skipBlanks(cursor, lineEnd);
+
+        if (startsWith(text, lineEnd, "#shader")) {
+            if (current != nullptr) current->lengths[0] = (int)(cursor - current->chunks[0]);
+            current = nullptr;
+
+            GLenum type = parseStageType(text + strlen("#shader"), lineEnd);
+            if (type == GL_NONE) {
+                std::cout << "ERROR::SHADER::UNKNOWN_STAGE " << std::string(text, lineEnd) << " in " << shaderPath << std::endl;
+            } else {
+                source.stages.push_back({type, {next}, {0}});
+                current = &source.stages.back();
             }
-        } else {
-            ss[(int)type] << line << "\n";
+        } else if (current == nullptr && text < lineEnd && *text != '\r') {
+            strayLines = true;
         }
+
+        cursor = next;
     }
+    if (current != nullptr) current->lengths[0] = (int)(end - current->chunks[0]);
 
-    return { ss[(int)ShaderType::VERTEX].str(), ss[(int)ShaderType::FRAGMENT].str()};
+    if (strayLines) {
+        std::cout << "WARNING::SHADER::CODE_OUTSIDE_STAGE ignored in " << shaderPath << std::endl;
+    }
+}
+
+void Shader::preprocessStage(Shader::ShaderSourceCode &source, Shader::ShaderStage &stage, const char *defineBlock,
+                             int defineLength, const std::string &directory, bool copy) {
+    const char* body = stage.chunks[0];
+    const char* end = body + stage.lengths[0];
+    stage.chunks.clear();
+    stage.lengths.clear();
+
+    // #version has to stay the first thing the compiler sees, so the defines go right after it
+    const char* rest = body;
+    for (const char* cursor = body; cursor < end;) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+        const char* next = lineEnd != nullptr ? lineEnd + 1 : end;
+        const char* text = skipBlanks(cursor, next);
+
+        if (startsWith(text, next, "#version")) {
+            stage.chunks.push_back(body);
+            stage.lengths.push_back((int)(next - body));
+            rest = next;
+            break;
+        }
+        bool blank = text == next || *text == '\n' || *text == '\r' || startsWith(text, next, "//");
+        if (!blank) break; // Code before any #version, so there is none
+        cursor = next;
+    }
+
+    if (defineBlock != nullptr) {
+        stage.chunks.push_back(defineBlock);
+        stage.lengths.push_back(defineLength);
+    }
+
+    expandIncludes(source, stage, rest, (size_t)(end - rest), directory, copy, 0);
+}
+
+void Shader::expandIncludes(Shader::ShaderSourceCode &source, Shader::ShaderStage &stage, const char *data,
+                            size_t size, const std::string &directory, bool copy, int depth) {
+    const char* end = data + size;
+    const char* chunkStart = data;
+
+    for (const char* cursor = data; cursor < end;) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+        const char* next = lineEnd != nullptr ? lineEnd + 1 : end;
+        if (lineEnd == nullptr) lineEnd = end;
+
+        const char* text = skipBlanks(cursor, lineEnd);
+        if (!startsWith(text, lineEnd, "#include")) {
+            cursor = next;
+            continue;
+        }
+
+        // Everything up to the #include line goes in as it is
+        if (cursor > chunkStart) {
+            stage.chunks.push_back(chunkStart);
+            stage.lengths.push_back((int)(cursor - chunkStart));
+        }
+        chunkStart = next;
+
+        const char* nameStart = skipBlanks(text + strlen("#include"), lineEnd);
+        const char* nameEnd = nameStart < lineEnd ? (const char*)memchr(nameStart + 1, *nameStart == '<' ? '>' : '"',
+                                                                        lineEnd - nameStart - 1) : nullptr;
+        if (nameStart >= lineEnd || (*nameStart != '"' && *nameStart != '<') || nameEnd == nullptr) {
+            std::cout << "ERROR::SHADER::BAD_INCLUDE " << std::string(cursor, lineEnd) << std::endl;
+            cursor = next;
+            continue;
+        }
+        if (depth >= 16) {
+            std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP (include cycle?) at " << std::string(cursor, lineEnd) << std::endl;
+            cursor = next;
+            continue;
+        }
+
+        std::string includePath = directory + "/" + std::string(nameStart + 1, nameEnd);
+        const char* included;
+        size_t includedSize;
+        if (loadFile(source, includePath, copy, included, includedSize)) {
+            expandIncludes(source, stage, included, includedSize, directoryOf(includePath), copy, depth + 1);
+            // Included files may not end in a new line, don't glue their last line to ours
+            stage.chunks.push_back("\n");
+            stage.lengths.push_back(1);
+        }
+
+        cursor = next;
+    }
+
+    if (end > chunkStart) {
+        stage.chunks.push_back(chunkStart);
+        stage.lengths.push_back((int)(end - chunkStart));
+    }
+}
+
+GLenum Shader::parseStageType(const char *name, const char *end) {
+    while (name < end && (*name == ' ' || *name == '\t')) name++;
+    const char* nameEnd = name;
+    while (nameEnd < end && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\r') nameEnd++;
+
+    std::string stage(name, nameEnd);
+    if (stage == "vertex") return GL_VERTEX_SHADER;
+    if (stage == "fragment") return GL_FRAGMENT_SHADER;
+    if (stage == "geometry") return GL_GEOMETRY_SHADER;
+    return GL_NONE;
+}
+
+const char *Shader::stageName(GLenum type) {
+    switch (type) {
+        case GL_VERTEX_SHADER: return "VERTEX";
+        case GL_FRAGMENT_SHADER: return "FRAGMENT";
+        case GL_GEOMETRY_SHADER: return "GEOMETRY";
+        default: return "UNKNOWN";
+    }
 }
 
 void Shader::compileShader(Shader::ShaderSourceCode &source) {
     // Compile shaders
     // =======================================
-    unsigned int vertex, fragment;
+    // Nothing here asks the driver for a status, so with parallel compile support all of this returns right away
+    // and the actual work happens on driver threads. Errors are checked in finishCompile.
+    ID = glCreateProgram();
+    if (GLExtensions::programBinary) {
+        GLExtensions::programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    for (const ShaderStage &stage : source.stages) {
+        unsigned int stageID = glCreateShader(stage.type);
+        glShaderSource(stageID, (GLsizei)stage.chunks.size(), stage.chunks.data(), stage.lengths.data());
+        glCompileShader(stageID);
+        glAttachShader(ID, stageID);
+        stageIDs.push_back(stageID);
+    }
+
+    // Create Shader Program ---------------
+    glLinkProgram(ID);
+
+    status = Status::COMPILING;
+}
+
+bool Shader::reload(Shader::ShaderSourceCode &source) {
+    if (status == Status::COMPILING) pollCompile(true); // Never leave a half finished program behind
+
+    unsigned int oldID = ID;
+    Status oldStatus = status;
+    std::string oldCachePath = cachePath;
+
+    loadStart = std::chrono::steady_clock::now();
+    loadedFromCache = false;
+    cachePath = binaryCachePath(source);
+
+    compileShader(source);
+    finishCompile();
+
+    if (status != Status::READY) {
+        glDeleteProgram(ID);
+        GLState::forgetProgram(ID);
+        ID = oldID;
+        status = oldStatus;
+        cachePath = oldCachePath;
+        return false;
+    }
+
+    glDeleteProgram(oldID);
+    GLState::forgetProgram(oldID);
+    dependencies = source.dependencies;
+    return true;
+}
+
+bool Shader::pollCompile(bool wait) {
+    if (status != Status::COMPILING) return true;
+
+    if (!wait) {
+        // Without the extension any status query blocks until the driver is done, so we can't peek
+        if (!GLExtensions::parallelShaderCompile) return false;
+
+        int completed = GL_FALSE;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &completed);
+        if (!completed) return false;
+    }
+
+    finishCompile();
+    return true;
+}
+
+void Shader::finishCompile() {
     int success;
     char infoLog[512];
-
-    // Vertex Shader compiling -----------
-    const char* vertexSource = source.vertex.c_str();
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertexSource, nullptr);
-    glCompileShader(vertex);
+    bool compiled = true;
 
     // Check for success
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    for (unsigned int stageID : stageIDs) {
+        glGetShaderiv(stageID, GL_COMPILE_STATUS, &success);
+        if(!success)
+        {
+            int type;
+            glGetShaderiv(stageID, GL_SHADER_TYPE, &type);
+            glGetShaderInfoLog(stageID, 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::" << stageName((GLenum)type) << "::COMPILATION_FAILED " << path << "\n"
+                      << infoLog << std::endl;
+            compiled = false;
+        }
+    }
+
+    // print linking errors if any
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
     if(!success)
     {
-        glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    };
+        glGetProgramInfoLog(ID, 512, nullptr, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << path << "\n" << infoLog << std::endl;
+        compiled = false;
+    }
 
-    // Fragment shader -----------
-    const char* fragmentSource = source.fragment.c_str();
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fragmentSource, nullptr);
-    glCompileShader(fragment);
+    for (unsigned int stageID : stageIDs) glDeleteShader(stageID);
+    stageIDs.clear();
 
-    // Check for success
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if(!success)
-    {
-        glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    };
+    if (!compiled) {
+        status = Status::FAILED;
+        return;
+    }
+
+    storeProgramBinary(cachePath);
+    finishLoad();
+}
+
+void Shader::finishLoad() {
+    cacheUniformLocations();
+    bindUniformBlocks();
+    reflectAttributes();
+    status = Status::READY;
+    revision++;
+
+    loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    if (!cachePath.empty()) {
+        std::cout << "SHADER::CACHE::" << (loadedFromCache ? "HIT " : "MISS ") << path
+                  << " (" << loadMilliseconds << " ms)" << std::endl;
+    }
+}
+
+std::string Shader::binaryCachePath(const Shader::ShaderSourceCode &source) {
+    if (binaryCacheDirectory.empty() || !GLExtensions::programBinary) return "";
+
+    // Binaries are only valid for the exact driver that produced them, so the driver identity is part of the key
+    unsigned long long hash = 14695981039346656037ull;
+    for (const ShaderStage &stage : source.stages) {
+        hash = hashBytes(hash, (const char*)&stage.type, sizeof(stage.type));
+        for (size_t i = 0; i < stage.chunks.size(); i++) {
+            hash = hashBytes(hash, stage.chunks[i], (size_t)stage.lengths[i]);
+        }
+    }
+    hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", hash);
+    return binaryCacheDirectory + name;
+}
+
+bool Shader::loadProgramBinary(const std::string &cachePath) {
+    if (cachePath.empty()) return false;
+
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file) return false;
+
+    ProgramBinaryHeader header{};
+    file.read((char*)&header, sizeof(header));
+    if (!file || header.magic != PROGRAM_BINARY_MAGIC || header.length == 0) return false;
+
+    std::vector<char> binary(header.length);
+    file.read(binary.data(), header.length);
+    if (!file) return false;
 
-    // Create Shader Program ---------------
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
+    GLExtensions::programBinaryLoad(ID, header.format, binary.data(), (GLsizei)header.length);
 
-    // print linking errors if any
+    // A driver update makes old binaries invalid, in that case we go back to compiling from source
+    int success;
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if(!success)
+    if (!success) {
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void Shader::storeProgramBinary(const std::string &cachePath) const {
+    if (cachePath.empty()) return;
+
+    int success, length = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!success || length <= 0) return;
+
+    std::vector<char> binary(length);
+    ProgramBinaryHeader header{PROGRAM_BINARY_MAGIC, 0, 0};
+    GLenum format;
+    GLExtensions::getProgramBinary(ID, length, &length, &format, binary.data());
+    header.format = format;
+    header.length = (unsigned int)length;
+
+    // Write to a temporary file first so a crash never leaves a half written binary behind
+    std::string temporaryPath = cachePath + ".tmp";
     {
-        glGetProgramInfoLog(ID, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cout << "ERROR::SHADER::CACHE::WRITE_FAILED " << cachePath << std::endl;
+            return;
+        }
     }
+    std::rename(temporaryPath.c_str(), cachePath.c_str());
+}
+
+void Shader::cacheUniformLocations() {
+    uniforms.clear();
+    uniformNames.clear();
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+    for (int i = 0; i < count; i++) {
+        int size;
+        GLenum type;
+        glGetActiveUniform(ID, i, maxLength, nullptr, &size, &type, name.data());
+
+        int location = glGetUniformLocation(ID, name.data());
+        if (location == -1) continue; // Uniforms inside blocks have no location
+
+        addUniformEntry(name.data(), location);
+
+        // Arrays are reported as "name[0]", also register the plain name so both spellings work
+        char* bracket = strstr(name.data(), "[0]");
+        if (bracket != nullptr) {
+            *bracket = '\0';
+            addUniformEntry(name.data(), location);
+        }
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(), [](const UniformEntry &a, const UniformEntry &b) {
+        return a.hash < b.hash;
+    });
+}
+
+void Shader::bindUniformBlocks() const {
+    // Every block goes to the binding point reserved for its name, so buffers bound there are seen by all shaders
+    int count = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+
+    char name[256];
+    for (int i = 0; i < count; i++) {
+        glGetActiveUniformBlockName(ID, i, sizeof(name), nullptr, name);
+        glUniformBlockBinding(ID, i, UniformBuffer::bindingPoint(name));
+    }
+}
+
+void Shader::reflectAttributes() {
+    attributes.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+    for (int i = 0; i < count; i++) {
+        int size;
+        GLenum type;
+        glGetActiveAttrib(ID, i, maxLength, nullptr, &size, &type, name.data());
+
+        int location = glGetAttribLocation(ID, name.data());
+        if (location == -1) continue; // Built ins like gl_VertexID
+        attributes.push_back({name.data(), location, type, size});
+    }
+
+    std::sort(attributes.begin(), attributes.end(), [](const Attribute &a, const Attribute &b) {
+        return a.location < b.location;
+    });
+}
+
+void Shader::addUniformEntry(const char* name, int location) {
+    UniformEntry entry{hashUniformName(name), (unsigned int)uniformNames.size(), location};
+    uniformNames.insert(uniformNames.end(), name, name + strlen(name) + 1);
+    uniforms.push_back(entry);
 }
 
 // Public Methods
+int Shader::getUniformLocation(const char *uniformName) const {
+    unsigned int hash = hashUniformName(uniformName);
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), hash, [](const UniformEntry &entry, unsigned int h) {
+        return entry.hash < h;
+    });
+
+    for (; it != uniforms.end() && it->hash == hash; ++it) {
+        if (strcmp(&uniformNames[it->nameOffset], uniformName) == 0) return it->location;
+    }
+
+    // Only the first element of an array is listed, other elements ("lights[3]") still need the driver
+    if (strchr(uniformName, '[') != nullptr) return glGetUniformLocation(ID, uniformName);
+
+    return -1; // Inactive or unknown uniform, glUniform* silently ignores -1
+}
+
 void Shader::setUniformFloat(const char *uniformName, float value) const {
-    glUniform1f(glGetUniformLocation(ID, uniformName), value);
+    glUniform1f(getUniformLocation(uniformName), value);
 }
 
 void Shader::setUniformInt(const char *uniformName, int value) const {
-    glUniform1i(glGetUniformLocation(ID, uniformName), value);
+    glUniform1i(getUniformLocation(uniformName), value);
 }
 
 void Shader::setUNiformBool(const char *uniformName, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, uniformName), (int)value);
+    glUniform1i(getUniformLocation(uniformName), (int)value);
+}
+
+void Shader::setUniformFloat(int location, float value) const {
+    glUniform1f(location, value);
+}
+
+void Shader::setUniformInt(int location, int value) const {
+    glUniform1i(location, value);
+}
+
+void Shader::setUNiformBool(int location, bool value) const {
+    glUniform1i(location, (int)value);
+}
+
+Shader::Status Shader::getStatus() const {
+    return status;
+}
+
+bool Shader::isReady() const {
+    return status == Status::READY;
+}
+
+const std::string &Shader::getPath() const {
+    return path;
+}
+
+const std::vector<std::string> &Shader::getDefines() const {
+    return defines;
+}
+
+const std::vector<std::string> &Shader::getDependencies() const {
+    return dependencies;
+}
+
+Shader::ShaderSourceCode Shader::readSource(bool copy) const {
+    return parseShader(path.c_str(), defines, copy);
+}
+
+const std::vector<Shader::Attribute> &Shader::getAttributes() const {
+    return attributes;
+}
+
+const Shader::Attribute *Shader::findAttribute(const std::string &name) const {
+    for (const Attribute &attribute : attributes) {
+        if (attribute.name == name) return &attribute;
+    }
+    return nullptr;
+}
+
+int Shader::getRevision() const {
+    return revision;
+}
+
+bool Shader::isLoadedFromCache() const {
+    return loadedFromCache;
+}
+
+double Shader::getLoadMilliseconds() const {
+    return loadMilliseconds;
 }
 
 void Shader::use() const {
-    glUseProgram(ID);
+    GLState::useProgram(ID);
 }
\ No newline at end of file
@@ -7,41 +7,182 @@
 
 #include <fstream>
 #include <string>
-#include <sstream>
 #include <glad/glad.h>
 #include <iostream>
+#include "MappedFile.h"
+#include <vector>
+#include <chrono>
 
 class Shader {
 public:
-    unsigned int ID; // Shader Program ID
+    unsigned int ID = 0; // Shader Program ID
+
+    enum class Status {
+        COMPILING,
+        READY,
+        FAILED
+    };
+
+    // An active vertex input, as reported by the driver after linking
+    struct Attribute {
+        std::string name;
+        int location;
+        GLenum type; // GL_FLOAT_VEC3, GL_INT, GL_FLOAT_MAT4...
+        int arraySize;
+    };
+
+    // A stage is a list of pointer/length chunks into the file contents. glShaderSource takes them as they are, so
+    // neither #include nor #define injection copy anything
+    struct ShaderStage {
+        GLenum type;
+        std::vector<const char*> chunks;
+        std::vector<int> lengths;
+    };
+
+    struct ShaderSourceCode {
+        MappedFile file;
+        std::vector<char> text; // Only used for copied sources, see parseShader
+        std::vector<MappedFile> includedFiles;
+        std::vector<std::vector<char>> ownedText; // The generated #define block and copied includes
+        std::vector<std::string> dependencies; // Every file that went into the source, the .shader file first
+        std::vector<ShaderStage> stages; // In the order they appear in the file
+    };
+
+    // Splits a .shader file into its stages, resolves #include "file" (relative to the including file) and puts
+    // a #define for each entry of defines ("NAME" or "NAME VALUE") right after #version.
+    // With copy the files are read into memory instead of mapped, use that when they may be rewritten while the
+    // source is still alive (a truncated mapping crashes on access).
+    static ShaderSourceCode parseShader(const char* shaderPath, const std::vector<std::string> &defines = {},
+                                        bool copy = false);
 
     explicit Shader(const char* shaderPath);
 
+    // With async the constructor only submits the sources, the program becomes usable once pollCompile succeeds
+    Shader(const char* shaderPath, bool async);
+
+    // A specialized permutation of the shader, see parseShader for the format of defines
+    Shader(const char* shaderPath, const std::vector<std::string> &defines, bool async = false);
+
+    Shader(const Shader&) = delete;
+    Shader &operator=(const Shader&) = delete;
+
+    // Directory where linked program binaries are kept between runs, an empty string disables the cache
+    static void setBinaryCacheDirectory(const std::string &directory);
+
     virtual ~Shader();
 
     void use() const;
 
+    // Finishes the program if the driver is done with it, never blocks unless wait is true
+    bool pollCompile(bool wait = false);
+
+    Status getStatus() const;
+
+    bool isReady() const;
+
+    const std::string &getPath() const;
+
+    const std::vector<std::string> &getDefines() const;
+
+    // Files the current program was built from, the .shader file and everything it includes
+    const std::vector<std::string> &getDependencies() const;
+
+    // Parses the shader file again with the same defines
+    ShaderSourceCode readSource(bool copy) const;
+
+    // Builds a new program from source and swaps it in only if it links, on failure the old program stays in use
+    bool reload(ShaderSourceCode &source);
+
+    // Active vertex inputs sorted by location
+    const std::vector<Attribute> &getAttributes() const;
+
+    const Attribute* findAttribute(const std::string &name) const;
+
+    // Goes up every time a new program is swapped in, uniform handles from an older revision are stale
+    int getRevision() const;
+
+    // Looks up a uniform in the table built at link time, resolve once and pass the handle to the setters below
+    int getUniformLocation(const char* uniformName) const;
+
     void setUniformFloat(const char* uniformName, float value) const;
 
     void setUniformInt(const char* uniformName, int value) const;
 
     void setUNiformBool(const char* uniformName, bool value) const;
 
+    // Overloads for pre-resolved handles, these make no lookups at all
+    void setUniformFloat(int location, float value) const;
+
+    void setUniformInt(int location, int value) const;
+
+    void setUNiformBool(int location, bool value) const;
+
+    bool isLoadedFromCache() const;
+
+    double getLoadMilliseconds() const; // Time spent from parsing to a usable program
+
 private:
-    struct ShaderSourceCode {
-        std::string vertex;
-        std::string fragment;
+    // One entry of the name -> location table, names live packed in uniformNames
+    struct UniformEntry {
+        unsigned int hash;
+        unsigned int nameOffset;
+        int location;
     };
 
-    enum ShaderType {
-        NONE = -1,
-        VERTEX = 0,
-        FRAGMENT = 1
-    };
+    std::vector<UniformEntry> uniforms; // Sorted by hash so lookups are a binary search over a flat array
+    std::vector<char> uniformNames; // All names back to back, null terminated
+
+    std::vector<Attribute> attributes;
+
+    std::string path;
+    std::vector<std::string> defines;
+    std::vector<std::string> dependencies;
+    Status status = Status::READY;
+    int revision = 0;
+
+    std::vector<unsigned int> stageIDs; // Only alive while the program is compiling
+
+    std::string cachePath;
+    std::chrono::steady_clock::time_point loadStart;
+    bool loadedFromCache = false;
+    double loadMilliseconds = 0.0;
+
+    static std::string binaryCacheDirectory;
+
+    static bool loadFile(ShaderSourceCode &source, const std::string &filePath, bool copy, const char* &data,
+                         size_t &size);
 
-    static ShaderSourceCode parseShader(const char* shaderPath);
+    static void splitStages(ShaderSourceCode &source, const char* data, size_t size, const char* shaderPath);
+
+    static void preprocessStage(ShaderSourceCode &source, ShaderStage &stage, const char* defineBlock,
+                                int defineLength, const std::string &directory, bool copy);
+
+    static void expandIncludes(ShaderSourceCode &source, ShaderStage &stage, const char* data, size_t size,
+                               const std::string &directory, bool copy, int depth);
+
+    static GLenum parseStageType(const char* name, const char* end);
+
+    static const char* stageName(GLenum type);
 
     void compileShader(ShaderSourceCode &source);
+
+    void finishCompile();
+
+    void finishLoad();
+
+    void cacheUniformLocations();
+
+    void bindUniformBlocks() const;
+
+    void reflectAttributes();
+
+    static std::string binaryCachePath(const ShaderSourceCode &source);
+
+    bool loadProgramBinary(const std::string &cachePath);
+
+    void storeProgramBinary(const std::string &cachePath) const;
+
+    void addUniformEntry(const char* name, int location);
 };
 
 #endif //LEARNOPENGL_SHADER_H
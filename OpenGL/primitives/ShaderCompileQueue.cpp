@@ -0,0 +1,34 @@
+#include "ShaderCompileQueue.h"
+#include "GLExtensions.h"
+#include <algorithm>
+
+ShaderCompileQueue::ShaderCompileQueue(int blockingBudget) : blockingBudget(blockingBudget) {}
+
+void ShaderCompileQueue::submit(Shader &shader) {
+    if (shader.getStatus() == Shader::Status::COMPILING) queue.push_back(&shader);
+}
+
+void ShaderCompileQueue::poll() {
+    int budget = blockingBudget;
+
+    for (Shader* shader : queue) {
+        if (GLExtensions::parallelShaderCompile) {
+            shader->pollCompile(); // Cheap, the driver just tells us if its threads are done
+        } else if (budget > 0) {
+            shader->pollCompile(true);
+            budget--;
+        }
+    }
+
+    queue.erase(std::remove_if(queue.begin(), queue.end(), [](Shader* shader) {
+        return shader->getStatus() != Shader::Status::COMPILING;
+    }), queue.end());
+}
+
+size_t ShaderCompileQueue::pending() const {
+    return queue.size();
+}
+
+bool ShaderCompileQueue::empty() const {
+    return queue.empty();
+}
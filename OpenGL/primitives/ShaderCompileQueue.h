@@ -0,0 +1,28 @@
+#ifndef LEARNOPENGL_SHADERCOMPILEQUEUE_H
+#define LEARNOPENGL_SHADERCOMPILEQUEUE_H
+
+#include <vector>
+#include "Shader.h"
+
+// Keeps track of shaders created with async = true and finishes them across frames instead of stalling on each one.
+class ShaderCompileQueue {
+public:
+    // blockingBudget is how many programs poll may finish per call when the driver has no parallel compile support,
+    // in that case every finish blocks until the driver is done with that program
+    explicit ShaderCompileQueue(int blockingBudget = 1);
+
+    void submit(Shader &shader);
+
+    // Call once per frame
+    void poll();
+
+    size_t pending() const;
+
+    bool empty() const;
+
+private:
+    std::vector<Shader*> queue; // Oldest submission first
+    int blockingBudget;
+};
+
+#endif //LEARNOPENGL_SHADERCOMPILEQUEUE_H
@@ -0,0 +1,41 @@
+#include "ShaderRegistry.h"
+#include <algorithm>
+
+ShaderRegistry::ShaderRegistry(ShaderCompileQueue *compileQueue, ShaderWatcher *watcher)
+        : compileQueue(compileQueue), watcher(watcher) {}
+
+ShaderRegistry::~ShaderRegistry() {
+    if (watcher != nullptr) {
+        for (auto &permutation : permutations) watcher->unwatch(*permutation.second);
+    }
+}
+
+Shader &ShaderRegistry::get(const std::string &shaderPath, const std::vector<std::string> &defines) {
+    std::string key = permutationKey(shaderPath, defines);
+
+    auto found = permutations.find(key);
+    if (found != permutations.end()) return *found->second;
+
+    std::unique_ptr<Shader> shader(new Shader(shaderPath.c_str(), defines, compileQueue != nullptr));
+    if (compileQueue != nullptr) compileQueue->submit(*shader);
+    if (watcher != nullptr) watcher->watch(*shader);
+
+    Shader &result = *shader;
+    permutations.emplace(std::move(key), std::move(shader));
+    return result;
+}
+
+size_t ShaderRegistry::size() const {
+    return permutations.size();
+}
+
+std::string ShaderRegistry::permutationKey(const std::string &shaderPath, std::vector<std::string> defines) {
+    std::sort(defines.begin(), defines.end());
+
+    std::string key = shaderPath;
+    for (const std::string &define : defines) {
+        key += '\n';
+        key += define;
+    }
+    return key;
+}
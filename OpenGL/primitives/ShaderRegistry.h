@@ -0,0 +1,38 @@
+#ifndef LEARNOPENGL_SHADERREGISTRY_H
+#define LEARNOPENGL_SHADERREGISTRY_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+#include "ShaderCompileQueue.h"
+#include "ShaderWatcher.h"
+
+// Owns every shader permutation in use. A permutation is a .shader file plus a set of #defines, it's compiled the
+// first time someone asks for it and handed out from the table after that.
+class ShaderRegistry {
+public:
+    // With a compile queue new permutations compile asynchronously, with a watcher they hot reload.
+    // Both have to outlive the registry.
+    explicit ShaderRegistry(ShaderCompileQueue* compileQueue = nullptr, ShaderWatcher* watcher = nullptr);
+
+    ~ShaderRegistry();
+
+    ShaderRegistry(const ShaderRegistry&) = delete;
+    ShaderRegistry &operator=(const ShaderRegistry&) = delete;
+
+    // The order of defines doesn't matter, {"A", "B"} and {"B", "A"} are the same permutation
+    Shader &get(const std::string &shaderPath, const std::vector<std::string> &defines = {});
+
+    size_t size() const;
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<Shader>> permutations;
+    ShaderCompileQueue* compileQueue;
+    ShaderWatcher* watcher;
+
+    static std::string permutationKey(const std::string &shaderPath, std::vector<std::string> defines);
+};
+
+#endif //LEARNOPENGL_SHADERREGISTRY_H
@@ -0,0 +1,178 @@
+#include "ShaderWatcher.h"
+#include <algorithm>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher() : running(true) {
+#ifdef __linux__
+    inotifyFD = inotify_init1(IN_NONBLOCK);
+    if (inotifyFD == -1) std::cout << "WARNING::SHADER::WATCHER falling back to polling" << std::endl;
+#endif
+    thread = std::thread(&ShaderWatcher::run, this);
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    running = false;
+    thread.join();
+#ifdef __linux__
+    if (inotifyFD != -1) close(inotifyFD);
+#endif
+}
+
+void ShaderWatcher::watch(Shader &shader) {
+    std::lock_guard<std::mutex> lock(mutex);
+    watchFiles(shader);
+}
+
+void ShaderWatcher::watchFiles(Shader &shader) {
+    files.erase(std::remove_if(files.begin(), files.end(), [&shader](const WatchedFile &file) {
+        return file.shader == &shader;
+    }), files.end());
+
+    for (const std::string &path : shader.getDependencies()) {
+        size_t slash = path.find_last_of('/');
+
+        WatchedFile file;
+        file.shader = &shader;
+        file.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+        file.name = slash == std::string::npos ? path : path.substr(slash + 1);
+        file.modifiedTime = modificationTime(path);
+
+#ifdef __linux__
+        if (inotifyFD != -1) {
+            // Watch the directory rather than the file, editors usually save by writing a new file and renaming it
+            bool known = false;
+            for (auto &directory : watchedDirectories) known = known || directory.second == file.directory;
+            if (!known) {
+                int wd = inotify_add_watch(inotifyFD, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (wd != -1) watchedDirectories.emplace_back(wd, file.directory);
+            }
+        }
+#endif
+        files.push_back(file);
+    }
+}
+
+void ShaderWatcher::unwatch(Shader &shader) {
+    std::lock_guard<std::mutex> lock(mutex);
+    files.erase(std::remove_if(files.begin(), files.end(), [&shader](const WatchedFile &file) {
+        return file.shader == &shader;
+    }), files.end());
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [&shader](const PendingReload &reload) {
+        return reload.shader == &shader;
+    }), pending.end());
+}
+
+int ShaderWatcher::update() {
+    std::vector<PendingReload> reloads;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reloads.swap(pending);
+    }
+
+    int swapped = 0;
+    for (PendingReload &reload : reloads) {
+        if (reload.shader->reload(*reload.source)) {
+            lastReloadMilliseconds = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - reload.changedAt).count();
+            std::cout << "SHADER::RELOADED " << reload.shader->getPath() << " (" << lastReloadMilliseconds << " ms)"
+                      << std::endl;
+            swapped++;
+
+            // The new source may include different files
+            std::lock_guard<std::mutex> lock(mutex);
+            watchFiles(*reload.shader);
+        } else {
+            std::cout << "ERROR::SHADER::RELOAD_FAILED keeping the previous program for " << reload.shader->getPath()
+                      << std::endl;
+        }
+    }
+    return swapped;
+}
+
+double ShaderWatcher::getLastReloadMilliseconds() const {
+    return lastReloadMilliseconds;
+}
+
+void ShaderWatcher::setOnChange(std::function<void()> callback) {
+    onChange = std::move(callback);
+}
+
+void ShaderWatcher::run() {
+    while (running) {
+#ifdef __linux__
+        if (inotifyFD != -1) {
+            // Wake up regularly so the destructor never waits long for us
+            pollfd descriptor{inotifyFD, POLLIN, 0};
+            if (::poll(&descriptor, 1, 100) <= 0) continue;
+
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(inotifyFD, buffer, sizeof(buffer))) > 0) {
+                for (char* cursor = buffer; cursor < buffer + length;) {
+                    auto* event = (inotify_event*)cursor;
+                    cursor += sizeof(inotify_event) + event->len;
+                    if (event->len == 0) continue;
+
+                    std::string directory;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        for (auto &watched : watchedDirectories) {
+                            if (watched.first == event->wd) directory = watched.second;
+                        }
+                    }
+                    fileChanged(directory, event->name);
+                }
+            }
+            continue;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (WatchedFile &file : files) {
+            long long modified = modificationTime(file.directory + "/" + file.name);
+            if (modified != file.modifiedTime) {
+                file.modifiedTime = modified;
+                queueReload(file.shader);
+            }
+        }
+    }
+}
+
+void ShaderWatcher::fileChanged(const std::string &directory, const char *name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (WatchedFile &file : files) {
+        if (file.directory == directory && file.name == name) queueReload(file.shader);
+    }
+}
+
+void ShaderWatcher::queueReload(Shader *shader) {
+    auto changedAt = std::chrono::steady_clock::now();
+
+    // Parsing happens here, off the render thread. The source is copied, the file might change again before the
+    // GL thread gets to it
+    std::unique_ptr<Shader::ShaderSourceCode> source(
+            new Shader::ShaderSourceCode(shader->readSource(true)));
+
+    bool merged = false;
+    for (PendingReload &reload : pending) {
+        if (reload.shader == shader) { // Several saves before the next frame, only the newest one matters
+            reload.source = std::move(source);
+            merged = true;
+        }
+    }
+    if (!merged) pending.push_back({shader, std::move(source), changedAt});
+    if (onChange) onChange();
+}
+
+long long ShaderWatcher::modificationTime(const std::string &path) {
+    struct stat info{};
+    if (stat(path.c_str(), &info) != 0) return -1;
+    return (long long)info.st_mtime;
+}
@@ -0,0 +1,79 @@
+#ifndef LEARNOPENGL_SHADERWATCHER_H
+#define LEARNOPENGL_SHADERWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Shader.h"
+
+// Hot reload for shaders. A background thread waits for changes on the watched files (inotify on Linux, polling the
+// modification time elsewhere) and parses them, update() then compiles the new source on the GL thread and swaps it
+// in. A source that fails to compile or link leaves the running program untouched.
+class ShaderWatcher {
+public:
+    ShaderWatcher();
+
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher &operator=(const ShaderWatcher&) = delete;
+
+    // Watches the shader file and everything it includes. The shader has to outlive the watcher
+    void watch(Shader &shader);
+
+    // After this returns the watcher never touches the shader again
+    void unwatch(Shader &shader);
+
+    // GL thread, once per frame before drawing. Returns how many shaders were swapped
+    int update();
+
+    // Time from the file change being seen to the new program being in use, for the last successful reload
+    double getLastReloadMilliseconds() const;
+
+    // Called on the watcher thread whenever a reload is queued, so a loop that only draws when asked knows to call
+    // update. Runs with the watcher's lock held, keep it short. Set it before watching anything
+    void setOnChange(std::function<void()> callback);
+
+private:
+    struct WatchedFile {
+        Shader* shader;
+        std::string directory;
+        std::string name;
+        long long modifiedTime; // Only used when polling
+    };
+
+    struct PendingReload {
+        Shader* shader;
+        std::unique_ptr<Shader::ShaderSourceCode> source;
+        std::chrono::steady_clock::time_point changedAt;
+    };
+
+    std::vector<WatchedFile> files; // Guarded by mutex
+    std::vector<PendingReload> pending; // Guarded by mutex
+    std::mutex mutex;
+
+    std::atomic<bool> running;
+    std::thread thread;
+    int inotifyFD = -1;
+    std::vector<std::pair<int, std::string>> watchedDirectories; // inotify watch descriptor -> directory
+
+    double lastReloadMilliseconds = 0.0;
+    std::function<void()> onChange;
+
+    void run();
+
+    void watchFiles(Shader &shader); // Expects the mutex to be held
+
+    void fileChanged(const std::string &directory, const char* name);
+
+    void queueReload(Shader* shader); // Expects the mutex to be held, the shader can't go away while we parse
+
+    static long long modificationTime(const std::string &path);
+};
+
+#endif //LEARNOPENGL_SHADERWATCHER_H
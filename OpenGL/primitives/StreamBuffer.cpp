@@ -0,0 +1,162 @@
+#include "StreamBuffer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include <chrono>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(GLenum target, size_t partitionSize, int partitions)
+        : target(target), partitionSize(partitionSize), partitions(partitions),
+          persistent(GLExtensions::bufferStorage), fences((size_t)partitions, nullptr) {
+    glGenBuffers(1, &ID);
+    createStorage();
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync fence : fences) {
+        if (fence != nullptr) glDeleteSync(fence);
+    }
+    if (persistent) {
+        GLState::bindBuffer(target, ID);
+        glUnmapBuffer(target);
+    }
+    glDeleteBuffers(1, &ID);
+    GLState::forgetBuffer(ID);
+}
+
+void StreamBuffer::createStorage() {
+    GLState::bindBuffer(target, ID);
+    GLsizeiptr size = (GLsizeiptr)(partitionSize * partitions);
+
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLExtensions::bufferStorageCreate(target, size, nullptr, flags);
+        persistentMemory = (char*)glMapBufferRange(target, 0, size, flags);
+        if (persistentMemory != nullptr) return;
+
+        // Immutable storage can't be redefined, start over with a new buffer for the fallback
+        std::cout << "WARNING::STREAM_BUFFER::PERSISTENT_MAP_FAILED falling back to unsynchronized mapping" << std::endl;
+        persistent = false;
+        glDeleteBuffers(1, &ID);
+        GLState::forgetBuffer(ID);
+        glGenBuffers(1, &ID);
+        GLState::bindBuffer(target, ID);
+    }
+
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+}
+
+void* StreamBuffer::begin() {
+    current = (current + 1) % partitions;
+    size_t offset = getOffset();
+
+    if (persistent) {
+        waitFor(current); // The memory is always mapped, all we can do is wait for the GPU to let go of it
+        return persistentMemory + offset;
+    }
+
+    GLsync fence = fences[current];
+    if (fence != nullptr) {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            // The GPU is behind, instead of stalling give the old storage to the driver and take a fresh one.
+            // Every partition lives in the new storage now, so none of the old fences mean anything
+            GLState::bindBuffer(target, ID);
+            glBufferData(target, (GLsizeiptr)(partitionSize * partitions), nullptr, GL_STREAM_DRAW);
+            for (GLsync &old : fences) {
+                if (old != nullptr) glDeleteSync(old);
+                old = nullptr;
+            }
+            stalls++;
+        } else {
+            glDeleteSync(fence);
+            fences[current] = nullptr;
+        }
+    }
+
+    // The fence (or orphaning) already made sure nobody reads this range, so the driver doesn't have to check
+    GLState::bindBuffer(target, ID);
+    void* memory = glMapBufferRange(target, (GLintptr)offset, (GLsizeiptr)partitionSize,
+                                    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (memory != nullptr) return memory;
+
+    // Out of memory or a lost context, the frame still gets its data through glBufferSubData in end
+    if (staging.empty()) {
+        std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED uploading with glBufferSubData instead" << std::endl;
+        staging.resize(partitionSize);
+    }
+    staged = true;
+    return staging.data();
+}
+
+void StreamBuffer::end() {
+    if (persistent) return; // Coherent, writes are visible to the GPU without doing anything
+
+    GLState::bindBuffer(target, ID);
+    if (staged) {
+        glBufferSubData(target, (GLintptr)getOffset(), (GLsizeiptr)partitionSize, staging.data());
+        staged = false;
+        return;
+    }
+    glUnmapBuffer(target);
+}
+
+void StreamBuffer::fence() {
+    if (current < 0) return;
+    if (fences[current] != nullptr) glDeleteSync(fences[current]);
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBuffer::waitFor(int partition) {
+    GLsync fence = fences[partition];
+    if (fence == nullptr) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        stalls++;
+
+        // Flush on the first wait so the fence actually reaches the GPU, then keep waiting in 1 ms steps
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do {
+            result = glClientWaitSync(fence, flags, 1000000);
+            flags = 0;
+        } while (result == GL_TIMEOUT_EXPIRED);
+
+        waitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    glDeleteSync(fence);
+    fences[partition] = nullptr;
+}
+
+size_t StreamBuffer::getOffset() const {
+    return current < 0 ? 0 : partitionSize * (size_t)current;
+}
+
+size_t StreamBuffer::getPartitionSize() const {
+    return partitionSize;
+}
+
+int StreamBuffer::getPartition() const {
+    return current;
+}
+
+unsigned int StreamBuffer::getID() const {
+    return ID;
+}
+
+bool StreamBuffer::isPersistent() const {
+    return persistent;
+}
+
+double StreamBuffer::takeWaitMilliseconds() {
+    double waited = waitMilliseconds;
+    waitMilliseconds = 0.0;
+    return waited;
+}
+
+unsigned int StreamBuffer::takeStalls() {
+    unsigned int count = stalls;
+    stalls = 0;
+    return count;
+}
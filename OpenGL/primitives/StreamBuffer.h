@@ -0,0 +1,71 @@
+#ifndef LEARNOPENGL_STREAMBUFFER_H
+#define LEARNOPENGL_STREAMBUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Ring buffer for data written by the CPU every frame. The buffer is split in partitions (3 by default) and every
+// frame writes the next one, a fence per partition tells us when the GPU is done reading it. With three partitions
+// the CPU fills frame N+2 while the GPU still draws frame N, and the driver never has to synchronize for us.
+//
+// With GL_ARB_buffer_storage the whole buffer stays mapped (persistent + coherent), begin just hands out a pointer.
+// On plain 3.3 every partition is mapped with GL_MAP_UNSYNCHRONIZED_BIT, and if its fence isn't done yet the buffer
+// is orphaned instead of waited on.
+class StreamBuffer {
+public:
+    StreamBuffer(GLenum target, size_t partitionSize, int partitions = 3);
+
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer &operator=(const StreamBuffer&) = delete;
+
+    // Moves to the next partition and returns where to write, at most getPartitionSize() bytes. If the driver refuses
+    // to map it this is CPU memory that end() uploads instead
+    void* begin();
+
+    // Done writing the current partition
+    void end();
+
+    // Call once the draws reading the current partition have been issued
+    void fence();
+
+    // Where the current partition starts in the buffer, for attribute pointers and glBindBufferRange
+    size_t getOffset() const;
+
+    size_t getPartitionSize() const;
+
+    int getPartition() const;
+
+    unsigned int getID() const;
+
+    bool isPersistent() const;
+
+    // Time begin spent waiting on fences since the last call
+    double takeWaitMilliseconds();
+
+    // How many times since the last call the GPU was still reading the partition we wanted (waited or orphaned)
+    unsigned int takeStalls();
+
+private:
+    GLenum target;
+    size_t partitionSize;
+    int partitions;
+    int current = -1;
+    unsigned int ID = 0;
+    bool persistent;
+    char* persistentMemory = nullptr;
+    std::vector<char> staging; // Written instead of the partition when mapping it failed
+    bool staged = false;
+    std::vector<GLsync> fences;
+
+    double waitMilliseconds = 0.0;
+    unsigned int stalls = 0;
+
+    void waitFor(int partition);
+
+    void createStorage();
+};
+
+#endif //LEARNOPENGL_STREAMBUFFER_H
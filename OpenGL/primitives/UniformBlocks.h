@@ -0,0 +1,25 @@
+#ifndef LEARNOPENGL_UNIFORMBLOCKS_H
+#define LEARNOPENGL_UNIFORMBLOCKS_H
+
+#include "../math/Matrix.h"
+
+// C++ side of resources/shaders/include/Uniforms.glsl, both have to match the std140 rules:
+// vec4 and mat4 columns sit on 16 byte boundaries, a float after them packs tightly, a block is padded to 16 bytes.
+
+// layout (std140) uniform FrameData, uploaded once per frame
+struct FrameData {
+    mat4 view;
+    mat4 projection;
+    float time;
+    float padding[3];
+};
+
+// layout (std140) uniform ObjectData, one per draw
+struct ObjectData {
+    vec4 offset; // xyz used, w padding
+};
+
+static_assert(sizeof(FrameData) == 144, "FrameData doesn't match the std140 layout");
+static_assert(sizeof(ObjectData) == 16, "ObjectData doesn't match the std140 layout");
+
+#endif //LEARNOPENGL_UNIFORMBLOCKS_H
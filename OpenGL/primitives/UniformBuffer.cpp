@@ -0,0 +1,67 @@
+#include "UniformBuffer.h"
+#include "GLState.h"
+#include <unordered_map>
+
+UniformBuffer::UniformBuffer(const char *blockName, size_t size) : binding(bindingPoint(blockName)), size(size) {
+    glGenBuffers(1, &ID);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)size, nullptr, GL_DYNAMIC_DRAW);
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &ID);
+    GLState::forgetBuffer(ID);
+}
+
+void UniformBuffer::update(const void *data, size_t updateSize, size_t offset) const {
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)offset, (GLsizeiptr)updateSize, data);
+}
+
+void UniformBuffer::orphan() const {
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)size, nullptr, GL_DYNAMIC_DRAW);
+}
+
+void UniformBuffer::bindBase() const {
+    GLState::bindUniformBuffer(binding, ID);
+}
+
+void UniformBuffer::bindRange(size_t offset, size_t rangeSize) const {
+    GLState::bindUniformBuffer(binding, ID, (GLintptr)offset, (GLsizeiptr)rangeSize);
+}
+
+size_t UniformBuffer::getSize() const {
+    return size;
+}
+
+unsigned int UniformBuffer::getID() const {
+    return ID;
+}
+
+unsigned int UniformBuffer::getBindingPoint() const {
+    return binding;
+}
+
+unsigned int UniformBuffer::bindingPoint(const std::string &blockName) {
+    static std::unordered_map<std::string, unsigned int> points;
+
+    auto found = points.find(blockName);
+    if (found != points.end()) return found->second;
+
+    unsigned int point = (unsigned int)points.size();
+    if (point == 36) { // The minimum every 3.3 driver supports
+        std::cout << "WARNING::UNIFORM_BUFFER::MANY_BINDINGS " << blockName << " may not fit" << std::endl;
+    }
+    points.emplace(blockName, point);
+    return point;
+}
+
+size_t UniformBuffer::offsetAlignment() {
+    static int alignment = 0;
+    if (alignment == 0) {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment <= 0) alignment = 256;
+    }
+    return (size_t)alignment;
+}
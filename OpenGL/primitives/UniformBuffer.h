@@ -0,0 +1,126 @@
+#ifndef LEARNOPENGL_UNIFORMBUFFER_H
+#define LEARNOPENGL_UNIFORMBUFFER_H
+
+#include <glad/glad.h>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Uniform buffer object. Every block name gets its own binding point (see bindingPoint), Shader binds the blocks it
+// uses to those points when it links, so a buffer only has to be bound once for every shader to see it.
+class UniformBuffer {
+public:
+    UniformBuffer(const char* blockName, size_t size);
+
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer &operator=(const UniformBuffer&) = delete;
+
+    void update(const void* data, size_t size, size_t offset = 0) const;
+
+    // Replaces the whole storage, the driver hands us fresh memory instead of waiting for draws still using the old one
+    void orphan() const;
+
+    void bindBase() const;
+
+    void bindRange(size_t offset, size_t size) const;
+
+    size_t getSize() const;
+
+    unsigned int getID() const;
+
+    unsigned int getBindingPoint() const;
+
+    // Binding point shared by every shader that declares a block with this name
+    static unsigned int bindingPoint(const std::string &blockName);
+
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, offsets passed to bindRange have to be a multiple of it
+    static size_t offsetAlignment();
+
+private:
+    unsigned int ID = 0;
+    unsigned int binding;
+    size_t size;
+};
+
+// A single std140 struct shared by all draws of a frame, like the camera matrices. Write into data, upload once.
+template <typename T>
+class UniformBlock {
+public:
+    T data{};
+
+    explicit UniformBlock(const char* blockName) : buffer(blockName, sizeof(T)) {
+        buffer.bindBase();
+    }
+
+    void upload() const {
+        buffer.update(&data, sizeof(T));
+    }
+
+private:
+    UniformBuffer buffer;
+};
+
+// Per object std140 structs packed in one big buffer. Objects push their data, the whole frame is uploaded in one go
+// and every draw just binds its own range of the buffer.
+template <typename T>
+class UniformArray {
+public:
+    UniformArray(const char* blockName, size_t capacity)
+            : buffer(blockName, alignedStride() * capacity), stride(alignedStride()), capacity(capacity),
+              staging(stride * capacity) {}
+
+    // Returns the slot to pass to bind
+    size_t push(const T &value) {
+        if (count == capacity) {
+            std::cout << "ERROR::UNIFORM_ARRAY::FULL capacity " << capacity << std::endl;
+            return capacity - 1;
+        }
+        memcpy(&staging[count * stride], &value, sizeof(T));
+        return count++;
+    }
+
+    void upload() const {
+        if (count == 0) return;
+        buffer.orphan();
+        buffer.update(staging.data(), count * stride);
+    }
+
+    void bind(size_t slot) const {
+        buffer.bindRange(slot * stride, sizeof(T));
+    }
+
+    // For code that records the binding to do it later, like the render queue
+    size_t offsetOf(size_t slot) const {
+        return slot * stride;
+    }
+
+    const UniformBuffer &getBuffer() const {
+        return buffer;
+    }
+
+    // Call at the start of every frame
+    void clear() {
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    UniformBuffer buffer;
+    size_t stride;
+    size_t capacity;
+    size_t count = 0;
+    std::vector<char> staging;
+
+    static size_t alignedStride() {
+        size_t alignment = UniformBuffer::offsetAlignment();
+        return (sizeof(T) + alignment - 1) / alignment * alignment;
+    }
+};
+
+#endif //LEARNOPENGL_UNIFORMBUFFER_H
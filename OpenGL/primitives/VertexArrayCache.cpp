@@ -0,0 +1,53 @@
+#include "VertexArrayCache.h"
+#include "GLState.h"
+
+VertexArrayCache::~VertexArrayCache() {
+    for (auto &entry : vertexArrays) {
+        glDeleteVertexArrays(1, &entry.second);
+        GLState::forgetVertexArray(entry.second);
+    }
+}
+
+unsigned int VertexArrayCache::get(const VertexFormat &format, unsigned int vertexBuffer, unsigned int indexBuffer) {
+    return get(std::vector<Stream>{{format, vertexBuffer, 0}}, indexBuffer);
+}
+
+unsigned int VertexArrayCache::get(const std::vector<Stream> &streams, unsigned int indexBuffer) {
+    Key key{streams, indexBuffer};
+    auto found = vertexArrays.find(key);
+    if (found != vertexArrays.end()) return found->second;
+
+    // Bind the VAO first so the attribute setup and the index buffer get recorded in it
+    unsigned int vertexArray;
+    glGenVertexArrays(1, &vertexArray);
+    GLState::bindVertexArray(vertexArray);
+    for (const Stream &stream : streams) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+        stream.format.apply(stream.offset);
+    }
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+    vertexArrays.emplace(std::move(key), vertexArray);
+    return vertexArray;
+}
+
+size_t VertexArrayCache::size() const {
+    return vertexArrays.size();
+}
+
+bool VertexArrayCache::Key::operator==(const VertexArrayCache::Key &other) const {
+    if (indexBuffer != other.indexBuffer || streams.size() != other.streams.size()) return false;
+    for (size_t i = 0; i < streams.size(); i++) {
+        const Stream &a = streams[i], &b = other.streams[i];
+        if (a.buffer != b.buffer || a.offset != b.offset || a.format != b.format) return false;
+    }
+    return true;
+}
+
+size_t VertexArrayCache::KeyHash::operator()(const VertexArrayCache::Key &key) const {
+    size_t hash = (size_t)key.indexBuffer * 40503u;
+    for (const Stream &stream : key.streams) {
+        hash = hash * 31 + (stream.format.hash() ^ ((size_t)stream.buffer * 2654435761u) ^ stream.offset);
+    }
+    return hash;
+}
@@ -0,0 +1,48 @@
+#ifndef LEARNOPENGL_VERTEXARRAYCACHE_H
+#define LEARNOPENGL_VERTEXARRAYCACHE_H
+
+#include <unordered_map>
+#include <vector>
+#include "VertexFormat.h"
+
+// Hands out one VAO per (formats, buffers, index buffer). Meshes that share buffers and layout share the VAO,
+// so it is created and specified once instead of per mesh.
+class VertexArrayCache {
+public:
+    // One buffer feeding the VAO, usually the vertices plus optionally a per instance buffer
+    struct Stream {
+        VertexFormat format;
+        unsigned int buffer;
+        size_t offset; // Where the data starts in the buffer, for ring buffers that move every frame
+    };
+
+    VertexArrayCache() = default;
+
+    ~VertexArrayCache();
+
+    VertexArrayCache(const VertexArrayCache&) = delete;
+    VertexArrayCache &operator=(const VertexArrayCache&) = delete;
+
+    // The format should be resolved against the shader that will draw with it
+    unsigned int get(const VertexFormat &format, unsigned int vertexBuffer, unsigned int indexBuffer);
+
+    unsigned int get(const std::vector<Stream> &streams, unsigned int indexBuffer);
+
+    size_t size() const;
+
+private:
+    struct Key {
+        std::vector<Stream> streams;
+        unsigned int indexBuffer;
+
+        bool operator==(const Key &other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+
+    std::unordered_map<Key, unsigned int, KeyHash> vertexArrays;
+};
+
+#endif //LEARNOPENGL_VERTEXARRAYCACHE_H
@@ -0,0 +1,222 @@
+#include "VertexFormat.h"
+#include "../geometry/VertexPacking.h"
+#include <cstring>
+#include <iostream>
+
+VertexFormat &VertexFormat::add(const std::string &name, int components, GLenum type, bool normalized) {
+    bool integer = !normalized && type != GL_FLOAT && type != GL_HALF_FLOAT && type != GL_DOUBLE && !isPackedType(type);
+    if (isPackedType(type) && components != 4) {
+        std::cout << "WARNING::VERTEX_FORMAT::PACKED_COMPONENTS " << name << " packed types always have 4 components" << std::endl;
+        components = 4;
+    }
+
+    unsigned int offset = (stride + 3) & ~3u;
+    attributes.push_back({name, -1, components, type, normalized, integer, offset});
+    stride = (offset + attributeSize(components, type) + 3) & ~3u;
+    return *this;
+}
+
+VertexFormat &VertexFormat::perInstance() {
+    divisor = 1;
+    return *this;
+}
+
+unsigned int VertexFormat::getDivisor() const {
+    return divisor;
+}
+
+VertexFormat VertexFormat::fromShader(const Shader &shader) {
+    VertexFormat format;
+    for (const Shader::Attribute &input : shader.getAttributes()) {
+        int components, columns;
+        GLenum baseType;
+        glslTypeShape(input.type, components, columns, baseType);
+
+        for (int column = 0; column < columns * input.arraySize; column++) {
+            std::string name = column == 0 ? input.name : input.name + "#" + std::to_string(column);
+            format.add(name, components, baseType);
+            format.attributes.back().location = input.location + column;
+        }
+    }
+    return format;
+}
+
+VertexFormat VertexFormat::resolve(const Shader &shader) const {
+    VertexFormat resolved = *this;
+    for (Attribute &attribute : resolved.attributes) {
+        const Shader::Attribute* input = shader.findAttribute(attribute.name);
+        attribute.location = input != nullptr ? input->location : -1;
+        if (input == nullptr) continue;
+
+        int components, columns;
+        GLenum baseType;
+        glslTypeShape(input->type, components, columns, baseType);
+        // A packed normal has 4 components but is fine for a vec3 input, GL just drops w
+        bool packedNormal = isPackedType(attribute.type) && components == 3;
+        if ((components != attribute.components && !packedNormal) || columns != 1) {
+            std::cout << "WARNING::VERTEX_FORMAT::MISMATCH " << attribute.name << " has " << attribute.components
+                      << " components, " << shader.getPath() << " expects " << components << "x" << columns << std::endl;
+        }
+    }
+    return resolved;
+}
+
+void VertexFormat::apply(size_t bufferOffset) const {
+    // For every attribute we tell GL which location it feeds, how many values and of what type it has, if integers
+    // are mapped to 0..1 (-1..1 if signed), the distance between two vertices and where in the vertex it starts
+    for (const Attribute &attribute : attributes) {
+        if (attribute.location < 0) continue;
+
+        if (attribute.integer) {
+            glVertexAttribIPointer(attribute.location, attribute.components, attribute.type, stride,
+                                   (void*)(bufferOffset + attribute.offset));
+        } else {
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                                  attribute.normalized ? GL_TRUE : GL_FALSE, stride, (void*)(bufferOffset + attribute.offset));
+        }
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribDivisor(attribute.location, divisor);
+    }
+}
+
+unsigned int VertexFormat::getStride() const {
+    return stride;
+}
+
+const std::vector<VertexFormat::Attribute> &VertexFormat::getAttributes() const {
+    return attributes;
+}
+
+std::vector<unsigned char> VertexFormat::pack(const float *source, size_t vertexCount) const {
+    unsigned int sourceStride = 0;
+    for (const Attribute &attribute : attributes) sourceStride += attribute.components;
+
+    std::vector<unsigned char> packed(stride * vertexCount, 0);
+    std::vector<float> column;
+    std::vector<unsigned char> converted;
+    unsigned int sourceOffset = 0;
+
+    // One attribute at a time: gather its floats together so the converters can run over a long contiguous array,
+    // then spread the results into the interleaved vertices
+    for (const Attribute &attribute : attributes) {
+        size_t values = (size_t)attribute.components * vertexCount;
+        column.resize(values);
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+            memcpy(&column[vertex * attribute.components], source + vertex * sourceStride + sourceOffset,
+                   attribute.components * sizeof(float));
+        }
+        sourceOffset += attribute.components;
+
+        unsigned int size = attributeSize(attribute.components, attribute.type);
+        converted.resize(size * vertexCount);
+        switch (attribute.type) {
+            case GL_FLOAT:
+                memcpy(converted.data(), column.data(), values * sizeof(float));
+                break;
+            case GL_HALF_FLOAT:
+                VertexPacking::toHalf(column.data(), (uint16_t*)converted.data(), values);
+                break;
+            case GL_UNSIGNED_BYTE:
+                if (attribute.normalized) VertexPacking::toUnorm8(column.data(), converted.data(), values);
+                else for (size_t i = 0; i < values; i++) converted[i] = (unsigned char)column[i];
+                break;
+            case GL_BYTE:
+                if (attribute.normalized) VertexPacking::toSnorm8(column.data(), (int8_t*)converted.data(), values);
+                else for (size_t i = 0; i < values; i++) converted[i] = (unsigned char)(signed char)column[i];
+                break;
+            case GL_INT_2_10_10_10_REV:
+                VertexPacking::toSnorm1010102(column.data(), (uint32_t*)converted.data(), vertexCount);
+                break;
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+                VertexPacking::toUnorm1010102(column.data(), (uint32_t*)converted.data(), vertexCount);
+                break;
+            case GL_INT:
+            case GL_UNSIGNED_INT:
+                for (size_t i = 0; i < values; i++) {
+                    int32_t value = (int32_t)column[i];
+                    memcpy(&converted[i * 4], &value, 4);
+                }
+                break;
+            default:
+                std::cout << "ERROR::VERTEX_FORMAT::PACK unsupported type for " << attribute.name << std::endl;
+                std::fill(converted.begin(), converted.end(), 0);
+                break;
+        }
+
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+            memcpy(&packed[vertex * stride + attribute.offset], &converted[vertex * size], size);
+        }
+    }
+
+    return packed;
+}
+
+size_t VertexFormat::hash() const {
+    size_t hash = stride * 2 + divisor;
+    for (const Attribute &attribute : attributes) {
+        size_t value = ((size_t)(attribute.location + 1) << 24) ^ ((size_t)attribute.components << 20) ^
+                       ((size_t)attribute.type << 4) ^ ((size_t)attribute.normalized << 1) ^ attribute.offset;
+        hash = hash * 31 + value;
+    }
+    return hash;
+}
+
+bool VertexFormat::operator==(const VertexFormat &other) const {
+    if (stride != other.stride || divisor != other.divisor || attributes.size() != other.attributes.size()) return false;
+    for (size_t i = 0; i < attributes.size(); i++) {
+        const Attribute &a = attributes[i], &b = other.attributes[i];
+        // Names don't matter to GL, two formats that set up the same pointers are the same
+        if (a.location != b.location || a.components != b.components || a.type != b.type ||
+            a.normalized != b.normalized || a.integer != b.integer || a.offset != b.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VertexFormat::operator!=(const VertexFormat &other) const {
+    return !(*this == other);
+}
+
+unsigned int VertexFormat::typeSize(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT: return 2;
+        case GL_DOUBLE: return 8;
+        default: return 4;
+    }
+}
+
+unsigned int VertexFormat::attributeSize(int components, GLenum type) {
+    return isPackedType(type) ? 4 : components * typeSize(type);
+}
+
+bool VertexFormat::isPackedType(GLenum type) {
+    return type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+}
+
+void VertexFormat::glslTypeShape(GLenum glslType, int &components, int &columns, GLenum &baseType) {
+    columns = 1;
+    baseType = GL_FLOAT;
+    switch (glslType) {
+        case GL_FLOAT: components = 1; break;
+        case GL_FLOAT_VEC2: components = 2; break;
+        case GL_FLOAT_VEC3: components = 3; break;
+        case GL_FLOAT_VEC4: components = 4; break;
+        case GL_FLOAT_MAT2: components = 2; columns = 2; break;
+        case GL_FLOAT_MAT3: components = 3; columns = 3; break;
+        case GL_FLOAT_MAT4: components = 4; columns = 4; break;
+        case GL_INT: components = 1; baseType = GL_INT; break;
+        case GL_INT_VEC2: components = 2; baseType = GL_INT; break;
+        case GL_INT_VEC3: components = 3; baseType = GL_INT; break;
+        case GL_INT_VEC4: components = 4; baseType = GL_INT; break;
+        case GL_UNSIGNED_INT: components = 1; baseType = GL_UNSIGNED_INT; break;
+        case GL_UNSIGNED_INT_VEC2: components = 2; baseType = GL_UNSIGNED_INT; break;
+        case GL_UNSIGNED_INT_VEC3: components = 3; baseType = GL_UNSIGNED_INT; break;
+        case GL_UNSIGNED_INT_VEC4: components = 4; baseType = GL_UNSIGNED_INT; break;
+        default: components = 4; break;
+    }
+}
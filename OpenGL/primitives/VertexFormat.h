@@ -0,0 +1,75 @@
+#ifndef LEARNOPENGL_VERTEXFORMAT_H
+#define LEARNOPENGL_VERTEXFORMAT_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+// Describes how the vertices sit in a buffer: attributes by name, in order, each one right after the previous.
+// Offsets and stride follow from that, and the locations come from the shader's reflection (see resolve), so nothing
+// has to be kept in sync with the layout (location = n) in the shader by hand.
+// Compact types (GL_HALF_FLOAT, normalized bytes, the 2_10_10_10 ones) are fine, every attribute and the stride are
+// kept at 4 byte boundaries since unaligned fetches are slow or broken on some hardware.
+class VertexFormat {
+public:
+    struct Attribute {
+        std::string name;
+        int location; // -1 until resolved
+        int components;
+        GLenum type; // GL_FLOAT, GL_INT, GL_UNSIGNED_BYTE, GL_INT_2_10_10_10_REV (4 components in one int)...
+        bool normalized;
+        bool integer; // Goes through glVertexAttribIPointer, the shader sees ints
+        unsigned int offset;
+    };
+
+    // Appends an attribute after the ones already added
+    VertexFormat &add(const std::string &name, int components, GLenum type = GL_FLOAT, bool normalized = false);
+
+    // The buffer holds one element per instance instead of per vertex (glVertexAttribDivisor 1)
+    VertexFormat &perInstance();
+
+    unsigned int getDivisor() const;
+
+    // The layout a buffer would need to feed every input of the shader, tightly packed in location order
+    static VertexFormat fromShader(const Shader &shader);
+
+    // Same layout with locations taken from the shader. Attributes the shader doesn't use stay in the buffer but
+    // aren't enabled, a mismatch between our component count and the shader input is reported
+    VertexFormat resolve(const Shader &shader) const;
+
+    // Sets up the attributes of the bound VAO to read from the buffer bound to GL_ARRAY_BUFFER, starting at offset
+    void apply(size_t bufferOffset = 0) const;
+
+    unsigned int getStride() const;
+
+    const std::vector<Attribute> &getAttributes() const;
+
+    // Builds the buffer contents for this layout from plain floats, for every vertex the components of each
+    // attribute in order (4 for a 2_10_10_10 one, xyz and w). Converts to the attribute types, so a compact format
+    // is filled the same way as a float one
+    std::vector<unsigned char> pack(const float* source, size_t vertexCount) const;
+
+    size_t hash() const;
+
+    bool operator==(const VertexFormat &other) const;
+
+    bool operator!=(const VertexFormat &other) const;
+
+    static unsigned int typeSize(GLenum type);
+
+    // Bytes one attribute takes, the packed types hold all their components in a single int
+    static unsigned int attributeSize(int components, GLenum type);
+
+    static bool isPackedType(GLenum type);
+
+private:
+    std::vector<Attribute> attributes;
+    unsigned int stride = 0;
+    unsigned int divisor = 0;
+
+    // Components and locations a GLSL input type takes, a mat4 is 4 vec4 columns on consecutive locations
+    static void glslTypeShape(GLenum glslType, int &components, int &columns, GLenum &baseType);
+};
+
+#endif //LEARNOPENGL_VERTEXFORMAT_H
@@ -1,17 +1,16 @@
 #shader vertex
 #version 330 core
+#include "include/Uniforms.glsl"
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 
 out vec3 ourColor;
 
-uniform float dx;
-uniform float dy;
-
 void main()
 {
-    vec3 pos = vec3(aPos.x + dx, aPos.y + dy, aPos.z);
-    gl_Position = vec4(pos, 1.0);
+    vec3 pos = aPos + offset.xyz;
+    gl_Position = projection * view * vec4(pos, 1.0);
     ourColor = pos;
 }
 
@@ -23,4 +22,4 @@ in vec3 ourColor;
 void main()
 {
     FragColor = vec4(ourColor, 1.0);
-}
\ No newline at end of file
+}
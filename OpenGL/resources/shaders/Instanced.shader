@@ -0,0 +1,30 @@
+#shader vertex
+#version 330 core
+#include "include/Uniforms.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+// Per instance, advances once per copy instead of once per vertex
+layout (location = 2) in vec2 aOffset;
+layout (location = 3) in float aScale;
+layout (location = 4) in vec3 aTint;
+
+out vec3 ourColor;
+
+void main()
+{
+    vec3 pos = aPos * aScale + vec3(aOffset, 0.0);
+    gl_Position = projection * view * vec4(pos, 1.0);
+    ourColor = aColor * aTint;
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+in vec3 ourColor;
+
+void main()
+{
+    FragColor = vec4(ourColor, 1.0);
+}
@@ -0,0 +1,11 @@
+// Mirrors primitives/UniformBlocks.h, change both together
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    float time;
+};
+
+layout (std140) uniform ObjectData {
+    vec4 offset;
+};
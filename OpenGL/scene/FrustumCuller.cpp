@@ -0,0 +1,233 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cmath>
+
+// Frustum
+// ===========================================================================
+
+Frustum Frustum::fromMatrix(const mat4 &viewProjection) {
+    // Gribb/Hartmann: each plane is the last row of the matrix plus or minus one of the others
+    mat4 rows = transpose(viewProjection);
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[3] + rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    // Normalized so the distances compare against radii
+    for (vec4 &plane : frustum.planes) plane = plane / length(plane.xyz());
+    return frustum;
+}
+
+bool Frustum::containsSphere(const vec3 &center, float radius) const {
+    for (const vec4 &plane : planes) {
+        if (dot(plane.xyz(), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+// FrustumCuller
+// ===========================================================================
+
+unsigned int FrustumCuller::add(const vec3 &center, float sphereRadius) {
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(sphereRadius);
+    nodes.clear();
+    return (unsigned int)radius.size() - 1;
+}
+
+void FrustumCuller::update(unsigned int id, const vec3 &center, float sphereRadius) {
+    centerX[id] = center.x;
+    centerY[id] = center.y;
+    centerZ[id] = center.z;
+    radius[id] = sphereRadius;
+    nodes.clear();
+}
+
+void FrustumCuller::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    nodes.clear();
+}
+
+size_t FrustumCuller::size() const {
+    return radius.size();
+}
+
+void FrustumCuller::buildHierarchy() {
+    unsigned int count = (unsigned int)radius.size();
+    nodes.clear();
+    if (count == 0) return;
+
+    sortedIds.resize(count);
+    for (unsigned int i = 0; i < count; i++) sortedIds[i] = i;
+
+    nodes.reserve(2 * (count / LEAF_SIZE + 1));
+    nodes.push_back(Node());
+    buildNode(0, 0, count);
+
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedZ.resize(count);
+    sortedRadius.resize(count);
+    for (unsigned int slot = 0; slot < count; slot++) {
+        unsigned int id = sortedIds[slot];
+        sortedX[slot] = centerX[id];
+        sortedY[slot] = centerY[id];
+        sortedZ[slot] = centerZ[id];
+        sortedRadius[slot] = radius[id];
+    }
+}
+
+bool FrustumCuller::hasHierarchy() const {
+    return !nodes.empty();
+}
+
+unsigned int FrustumCuller::buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count) {
+    // Bounds of the spheres, and of their centers to pick the split
+    vec3 min(INFINITY), max(-INFINITY), centerMin(INFINITY), centerMax(-INFINITY);
+    for (unsigned int slot = first; slot < first + count; slot++) {
+        unsigned int id = sortedIds[slot];
+        vec3 center(centerX[id], centerY[id], centerZ[id]);
+        for (int axis = 0; axis < 3; axis++) {
+            min[axis] = std::min(min[axis], center[axis] - radius[id]);
+            max[axis] = std::max(max[axis], center[axis] + radius[id]);
+            centerMin[axis] = std::min(centerMin[axis], center[axis]);
+            centerMax[axis] = std::max(centerMax[axis], center[axis]);
+        }
+    }
+    nodes[nodeIndex].min = min;
+    nodes[nodeIndex].max = max;
+    nodes[nodeIndex].first = first;
+    nodes[nodeIndex].count = count;
+    nodes[nodeIndex].left = 0;
+    if (count <= LEAF_SIZE) return nodeIndex;
+
+    // Median split along the longest axis of the centers, keeps the tree balanced whatever the distribution
+    vec3 extent = centerMax - centerMin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    const std::vector<float> &key = axis == 0 ? centerX : (axis == 1 ? centerY : centerZ);
+    unsigned int half = count / 2;
+    std::nth_element(sortedIds.begin() + first, sortedIds.begin() + first + half, sortedIds.begin() + first + count,
+                     [&](unsigned int a, unsigned int b) { return key[a] < key[b]; });
+
+    unsigned int left = (unsigned int)nodes.size();
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    nodes[nodeIndex].left = left;
+    buildNode(left, first, half);
+    buildNode(left + 1, first + half, count - half);
+    return nodeIndex;
+}
+
+void FrustumCuller::cull(const Frustum &frustum, std::vector<unsigned int> &visible) {
+    visible.clear();
+    stats = {(unsigned int)radius.size(), 0, 0, 0};
+
+    if (hasHierarchy()) {
+        visit(frustum, 0, 0x3F, visible);
+    } else {
+        testSpheres(frustum, centerX.data(), centerY.data(), centerZ.data(), radius.data(), nullptr, 0,
+                    (unsigned int)radius.size(), visible);
+    }
+    stats.culled = stats.objects - (unsigned int)visible.size();
+}
+
+const FrustumCuller::Stats &FrustumCuller::lastStats() const {
+    return stats;
+}
+
+void FrustumCuller::visit(const Frustum &frustum, unsigned int nodeIndex, unsigned int planeMask,
+                          std::vector<unsigned int> &visible) {
+    const Node &node = nodes[nodeIndex];
+    stats.nodesVisited++;
+
+    // Box against each plane still in play: the corner furthest along the normal decides if it's all outside, the
+    // nearest one if it's all inside. Planes a box is fully inside of stay satisfied for all its children
+    for (int plane = 0; plane < 6; plane++) {
+        if ((planeMask & (1u << plane)) == 0) continue;
+        const vec4 &p = frustum.planes[plane];
+        vec3 positive(p.x >= 0 ? node.max.x : node.min.x, p.y >= 0 ? node.max.y : node.min.y,
+                      p.z >= 0 ? node.max.z : node.min.z);
+        vec3 negative(p.x >= 0 ? node.min.x : node.max.x, p.y >= 0 ? node.min.y : node.max.y,
+                      p.z >= 0 ? node.min.z : node.max.z);
+        if (dot(p.xyz(), positive) + p.w < 0.0f) return;
+        if (dot(p.xyz(), negative) + p.w >= 0.0f) planeMask &= ~(1u << plane);
+    }
+
+    if (planeMask == 0) {
+        // Entirely inside, everything below is visible without testing. A subtree's objects are one contiguous range
+        visible.insert(visible.end(), sortedIds.begin() + node.first, sortedIds.begin() + node.first + node.count);
+        return;
+    }
+
+    if (node.left == 0) {
+        testSpheres(frustum, sortedX.data(), sortedY.data(), sortedZ.data(), sortedRadius.data(), sortedIds.data(),
+                    node.first, node.count, visible);
+        return;
+    }
+
+    unsigned int left = node.left; // nodes doesn't change while culling, but keep no reference across the recursion
+    visit(frustum, left, planeMask, visible);
+    visit(frustum, left + 1, planeMask, visible);
+}
+
+void FrustumCuller::testSpheres(const Frustum &frustum, const float *x, const float *y, const float *z,
+                                const float *r, const unsigned int *ids, unsigned int first, unsigned int count,
+                                std::vector<unsigned int> &visible) {
+    unsigned int i = first, end = first + count;
+    stats.tested += count;
+
+#if MATH_AVX
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i), cy = _mm256_loadu_ps(y + i), cz = _mm256_loadu_ps(z + i);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+        __m256 outside = _mm256_setzero_ps();
+        for (const vec4 &plane : frustum.planes) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(cy, _mm256_set1_ps(plane.y)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(cz, _mm256_set1_ps(plane.z)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+        }
+        unsigned int inside = ~(unsigned int)_mm256_movemask_ps(outside) & 0xFF;
+        while (inside != 0) {
+            unsigned int lane = (unsigned int)__builtin_ctz(inside);
+            inside &= inside - 1;
+            visible.push_back(ids != nullptr ? ids[i + lane] : i + lane);
+        }
+    }
+#endif
+#if MATH_SSE
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+        __m128 outside = _mm_setzero_ps();
+        for (const vec4 &plane : frustum.planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+        }
+        int inside = ~_mm_movemask_ps(outside) & 0xF;
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            if (inside & (1 << lane)) visible.push_back(ids != nullptr ? ids[i + lane] : i + lane);
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        bool inside = true;
+        for (const vec4 &plane : frustum.planes) {
+            if (plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w < -r[i]) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) visible.push_back(ids != nullptr ? ids[i] : i);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef LEARNOPENGL_FRUSTUMCULLER_H
+#define LEARNOPENGL_FRUSTUMCULLER_H
+
+#include <cstdint>
+#include <vector>
+#include "../math/Matrix.h"
+
+// The six planes of a view projection, normals pointing inside: a point p is inside when dot(plane.xyz, p) + plane.w
+// is positive for all of them
+struct Frustum {
+    vec4 planes[6]; // left, right, bottom, top, near, far
+
+    static Frustum fromMatrix(const mat4 &viewProjection);
+
+    bool containsSphere(const vec3 &center, float radius) const;
+};
+
+// Keeps the bounding spheres of a set of objects as structure of arrays and finds the ones inside a frustum, testing
+// 4 spheres per instruction with SSE (8 with AVX). For big scenes that don't move, buildHierarchy puts a BVH on top so
+// whole groups are accepted or rejected with one box test. Plain CPU code, no GL involved.
+class FrustumCuller {
+public:
+    struct Stats {
+        unsigned int objects;
+        unsigned int tested; // Sphere tests actually done, the BVH accepts whole nodes without any
+        unsigned int culled;
+        unsigned int nodesVisited;
+    };
+
+    // Returns the object's id, ids are dense and stay valid until clear
+    unsigned int add(const vec3 &center, float radius);
+
+    void update(unsigned int id, const vec3 &center, float radius);
+
+    void clear();
+
+    size_t size() const;
+
+    // Builds the BVH over the current spheres, it is dropped again by add, update and clear
+    void buildHierarchy();
+
+    bool hasHierarchy() const;
+
+    // Ids of the objects inside the frustum, in ascending order without the BVH and in BVH order with it
+    void cull(const Frustum &frustum, std::vector<unsigned int> &visible);
+
+    const Stats &lastStats() const;
+
+private:
+    // Leaves hold up to this many objects, a couple of SIMD batches
+    static const unsigned int LEAF_SIZE = 8;
+
+    struct Node {
+        vec3 min;
+        vec3 max;
+        unsigned int first; // Objects below this node are slots first..first + count of the hierarchy order
+        unsigned int count;
+        unsigned int left; // Children are left and left + 1, 0 for a leaf (the root is nobody's child)
+    };
+
+    // Spheres as added
+    std::vector<float> centerX, centerY, centerZ, radius;
+
+    // Same spheres reordered so each leaf is contiguous, and the id each slot came from
+    std::vector<float> sortedX, sortedY, sortedZ, sortedRadius;
+    std::vector<unsigned int> sortedIds;
+    std::vector<Node> nodes;
+
+    Stats stats = {0, 0, 0, 0};
+
+    unsigned int buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count);
+
+    void visit(const Frustum &frustum, unsigned int nodeIndex, unsigned int planeMask, std::vector<unsigned int> &visible);
+
+    // Sphere tests over a contiguous range of SoA arrays, ids maps a slot to the id to report (null: the slot itself)
+    void testSpheres(const Frustum &frustum, const float* x, const float* y, const float* z, const float* r,
+                     const unsigned int* ids, unsigned int first, unsigned int count, std::vector<unsigned int> &visible);
+};
+
+#endif //LEARNOPENGL_FRUSTUMCULLER_H
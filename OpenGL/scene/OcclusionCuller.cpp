@@ -0,0 +1,276 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+// Clip space w below this counts as behind the camera
+static const float nearW = 1e-4f;
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height, JobSystem* jobs)
+        : width((width + 3) & ~3u), height(height), jobs(jobs) {
+    // Pyramid down to 1x1, every level rounding up so the edge texels still cover the whole buffer
+    unsigned int levelWidth = this->width, levelHeight = height;
+    while (true) {
+        levels.push_back({levelWidth, levelHeight, std::vector<float>((size_t)levelWidth * levelHeight, 1.0f)});
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = std::max(1u, (levelWidth + 1) / 2);
+        levelHeight = std::max(1u, (levelHeight + 1) / 2);
+    }
+}
+
+void OcclusionCuller::beginFrame(const mat4 &viewProjection) {
+    this->viewProjection = viewProjection;
+    triangles.clear();
+    stats = {0, 0, 0, 0.0f};
+}
+
+void OcclusionCuller::addOccluder(const mat4 &model, const vec3 *positions, const unsigned int *indices,
+                                  size_t indexCount, bool twoSided) {
+    mat4 transform = viewProjection * model;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        vec4 a = transform * vec4(positions[indices[i]], 1.0f);
+        vec4 b = transform * vec4(positions[indices[i + 1]], 1.0f);
+        vec4 c = transform * vec4(positions[indices[i + 2]], 1.0f);
+
+        bool behindA = a.w < nearW, behindB = b.w < nearW, behindC = c.w < nearW;
+        if (behindA && behindB && behindC) continue;
+        if (!behindA && !behindB && !behindC) {
+            addClippedTriangle(a, b, c, twoSided);
+            continue;
+        }
+
+        // Clip against the near plane, what's left is a triangle or a quad
+        vec4 input[3] = {a, b, c};
+        vec4 output[4];
+        int count = 0;
+        for (int edge = 0; edge < 3; edge++) {
+            const vec4 &from = input[edge], &to = input[(edge + 1) % 3];
+            bool fromInside = from.w >= nearW, toInside = to.w >= nearW;
+            if (fromInside) output[count++] = from;
+            if (fromInside != toInside) {
+                float t = (nearW - from.w) / (to.w - from.w);
+                output[count++] = lerp(from, to, t);
+            }
+        }
+        addClippedTriangle(output[0], output[1], output[2], twoSided);
+        if (count == 4) addClippedTriangle(output[0], output[2], output[3], twoSided);
+    }
+}
+
+void OcclusionCuller::addClippedTriangle(const vec4 &a, const vec4 &b, const vec4 &c, bool twoSided) {
+    ScreenTriangle triangle;
+    const vec4* corners[3] = {&a, &b, &c};
+    for (int i = 0; i < 3; i++) {
+        float inverseW = 1.0f / corners[i]->w;
+        triangle.x[i] = (corners[i]->x * inverseW * 0.5f + 0.5f) * width;
+        triangle.y[i] = (corners[i]->y * inverseW * 0.5f + 0.5f) * height;
+        triangle.z[i] = std::min(std::max(corners[i]->z * inverseW * 0.5f + 0.5f, 0.0f), 1.0f);
+    }
+
+    // Back faces and degenerate triangles go, the front faces of a closed occluder hide them anyway. Two sided
+    // ones are turned around instead, the rasterizer only takes counter clockwise
+    float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+                 (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+    if (area < 0.0f && twoSided) {
+        std::swap(triangle.x[1], triangle.x[2]);
+        std::swap(triangle.y[1], triangle.y[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+        area = -area;
+    }
+    if (area <= 0.0f) return;
+
+    float minY = std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]));
+    float maxY = std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]));
+    float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+    float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+    if (maxY < 0.0f || minY > (float)height || maxX < 0.0f || minX > (float)width) return;
+
+    triangle.minY = std::max(0, (int)std::floor(minY));
+    triangle.maxY = std::min((int)height - 1, (int)std::ceil(maxY));
+    triangles.push_back(triangle);
+    stats.occluderTriangles++;
+}
+
+void OcclusionCuller::rasterize() {
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned int bands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    if (jobs) {
+        // Bands don't share any pixels, one job each
+        jobs->parallelFor(0, bands, 1, [this](size_t first, size_t last) {
+            for (size_t band = first; band < last; band++) rasterizeBand((unsigned int)band);
+        });
+    } else {
+        for (unsigned int band = 0; band < bands; band++) rasterizeBand(band);
+    }
+
+    buildPyramid();
+    stats.rasterMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void OcclusionCuller::rasterizeBand(unsigned int band) {
+    int bandTop = (int)(band * BAND_HEIGHT);
+    int bandBottom = std::min((int)height, bandTop + (int)BAND_HEIGHT) - 1;
+    float* depth = levels[0].depth.data();
+
+    for (int row = bandTop; row <= bandBottom; row++) {
+        std::fill(depth + (size_t)row * width, depth + (size_t)(row + 1) * width, 1.0f);
+    }
+
+    for (const ScreenTriangle &triangle : triangles) {
+        if (triangle.maxY < bandTop || triangle.minY > bandBottom) continue;
+
+        // Edge functions, positive inside for a counter clockwise triangle: e(x, y) = a * x + b * y + c
+        float edgeA[3], edgeB[3], edgeC[3];
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3;
+            edgeA[i] = triangle.y[i] - triangle.y[j];
+            edgeB[i] = triangle.x[j] - triangle.x[i];
+            edgeC[i] = triangle.x[i] * triangle.y[j] - triangle.x[j] * triangle.y[i];
+        }
+
+        // Depth is linear in screen space after the divide, z(x, y) = z0 + dzdx * (x - x0) + dzdy * (y - y0)
+        float area = edgeC[0] + edgeC[1] + edgeC[2];
+        float dzdx = (edgeA[1] * triangle.z[0] + edgeA[2] * triangle.z[1] + edgeA[0] * triangle.z[2]) / area;
+        float dzdy = (edgeB[1] * triangle.z[0] + edgeB[2] * triangle.z[1] + edgeB[0] * triangle.z[2]) / area;
+        float z0 = triangle.z[0] - dzdx * triangle.x[0] - dzdy * triangle.y[0];
+
+        float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+        float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+        int startX = std::max(0, (int)std::floor(minX)) & ~3; // Whole groups of 4, rows are a multiple of 4 wide
+        int endX = std::min((int)width - 1, (int)std::ceil(maxX));
+        int startY = std::max(bandTop, triangle.minY), endY = std::min(bandBottom, triangle.maxY);
+
+#if MATH_SSE
+        const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]);
+        __m128 zx = _mm_set1_ps(dzdx);
+        for (int y = startY; y <= endY; y++) {
+            float centerY = (float)y + 0.5f;
+            __m128 rowE0 = _mm_set1_ps(edgeB[0] * centerY + edgeC[0]);
+            __m128 rowE1 = _mm_set1_ps(edgeB[1] * centerY + edgeC[1]);
+            __m128 rowE2 = _mm_set1_ps(edgeB[2] * centerY + edgeC[2]);
+            __m128 rowZ = _mm_set1_ps(z0 + dzdy * centerY);
+            float* line = depth + (size_t)y * width;
+
+            for (int x = startX; x <= endX; x += 4) {
+                __m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, centerX), rowE0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, centerX), rowE1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, centerX), rowE2);
+                // All three edge functions are >= 0 when their sign bits are all clear
+                int outside = _mm_movemask_ps(_mm_or_ps(_mm_or_ps(e0, e1), e2));
+                if (outside == 0xF) continue;
+
+                __m128 inside = _mm_castsi128_ps(_mm_cmpeq_epi32(
+                        _mm_srai_epi32(_mm_castps_si128(_mm_or_ps(_mm_or_ps(e0, e1), e2)), 31), _mm_setzero_si128()));
+                __m128 z = _mm_add_ps(_mm_mul_ps(zx, centerX), rowZ);
+                __m128 current = _mm_loadu_ps(line + x);
+                __m128 nearer = _mm_min_ps(current, z);
+                _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+        }
+#else
+        for (int y = startY; y <= endY; y++) {
+            float centerY = (float)y + 0.5f;
+            float* line = depth + (size_t)y * width;
+            for (int x = startX; x <= endX; x++) {
+                float centerX = (float)x + 0.5f;
+                bool inside = true;
+                for (int i = 0; i < 3; i++) inside &= edgeA[i] * centerX + edgeB[i] * centerY + edgeC[i] >= 0.0f;
+                if (!inside) continue;
+                line[x] = std::min(line[x], z0 + dzdx * centerX + dzdy * centerY);
+            }
+        }
+#endif
+    }
+}
+
+void OcclusionCuller::buildPyramid() {
+    for (size_t level = 1; level < levels.size(); level++) {
+        const Level &source = levels[level - 1];
+        Level &target = levels[level];
+        for (unsigned int y = 0; y < target.height; y++) {
+            unsigned int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+            for (unsigned int x = 0; x < target.width; x++) {
+                unsigned int x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+                // Farthest of the four, a box is hidden by a texel only if it's behind everything in it
+                float farthest = std::max(std::max(source.depth[y0 * source.width + x0], source.depth[y0 * source.width + x1]),
+                                          std::max(source.depth[y1 * source.width + x0], source.depth[y1 * source.width + x1]));
+                target.depth[y * target.width + x] = farthest;
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isVisible(const vec3 &min, const vec3 &max) {
+    stats.tested++;
+
+    // Screen rectangle and nearest depth of the 8 corners
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY, nearest = INFINITY;
+    for (int corner = 0; corner < 8; corner++) {
+        vec4 clip = viewProjection * vec4(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y,
+                                          corner & 4 ? max.z : min.z, 1.0f);
+        if (clip.w < nearW) return true;
+        float inverseW = 1.0f / clip.w;
+        float x = (clip.x * inverseW * 0.5f + 0.5f) * width, y = (clip.y * inverseW * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, clip.z * inverseW * 0.5f + 0.5f);
+    }
+
+    // Off screen is the frustum culler's business, count it as visible here
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)width || minY >= (float)height) return true;
+    minX = std::max(minX, 0.0f);
+    minY = std::max(minY, 0.0f);
+    maxX = std::min(maxX, (float)width - 1.0f);
+    maxY = std::min(maxY, (float)height - 1.0f);
+
+    // The level where the rectangle spans about two texels each way
+    float extent = std::max(maxX - minX, maxY - minY);
+    size_t level = extent > 1.0f ? (size_t)std::ceil(std::log2(extent)) : 0;
+    level = std::min(level > 0 ? level - 1 : 0, levels.size() - 1);
+
+    const Level &hiZ = levels[level];
+    unsigned int x0 = (unsigned int)minX >> level, x1 = std::min((unsigned int)maxX >> level, hiZ.width - 1);
+    unsigned int y0 = (unsigned int)minY >> level, y1 = std::min((unsigned int)maxY >> level, hiZ.height - 1);
+    for (unsigned int y = y0; y <= y1; y++) {
+        for (unsigned int x = x0; x <= x1; x++) {
+            if (nearest <= hiZ.depth[y * hiZ.width + x]) return true;
+        }
+    }
+
+    stats.occluded++;
+    return false;
+}
+
+const OcclusionCuller::Stats &OcclusionCuller::lastStats() const {
+    return stats;
+}
+
+unsigned int OcclusionCuller::getWidth() const {
+    return width;
+}
+
+unsigned int OcclusionCuller::getHeight() const {
+    return height;
+}
+
+const float *OcclusionCuller::getDepth(size_t level) const {
+    return levels[level].depth.data();
+}
+
+size_t OcclusionCuller::getLevelCount() const {
+    return levels.size();
+}
+
+unsigned int OcclusionCuller::getLevelWidth(size_t level) const {
+    return levels[level].width;
+}
+
+unsigned int OcclusionCuller::getLevelHeight(size_t level) const {
+    return levels[level].height;
+}
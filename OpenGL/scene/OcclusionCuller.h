@@ -0,0 +1,85 @@
+#ifndef LEARNOPENGL_OCCLUSIONCULLER_H
+#define LEARNOPENGL_OCCLUSIONCULLER_H
+
+#include <vector>
+#include "../math/Matrix.h"
+#include "../core/JobSystem.h"
+
+// Software occlusion culling. A few big occluder meshes are rasterized on the CPU into a small depth buffer, the
+// buffer is reduced into a hierarchical Z pyramid holding the farthest depth of every 2x2 block, and object bounding
+// boxes are checked against the level where they cover just a couple of texels: a box whose nearest point is behind
+// everything there is hidden. Rasterizing works on 4 pixels at a time with SSE, split into horizontal bands that
+// run as jobs. Nothing here touches GL.
+class OcclusionCuller {
+public:
+    struct Stats {
+        unsigned int occluderTriangles; // After clipping and back face removal
+        unsigned int tested;
+        unsigned int occluded;
+        float rasterMilliseconds; // Rasterization and pyramid build
+    };
+
+    // Width is rounded up to a multiple of 4. Without a job system the bands are done one after the other
+    OcclusionCuller(unsigned int width, unsigned int height, JobSystem* jobs = nullptr);
+
+    // Forgets last frame's occluders
+    void beginFrame(const mat4 &viewProjection);
+
+    // Transforms and clips the triangles right away, they are drawn by rasterize. Counter clockwise is front facing
+    // and back faces are dropped, unless twoSided: open or flat occluders (a wall, a single triangle) have no front
+    // face on the other side to hide things
+    void addOccluder(const mat4 &model, const vec3* positions, const unsigned int* indices, size_t indexCount,
+                     bool twoSided = false);
+
+    // Fills the depth buffer and builds the pyramid, helping with the bands until it's done
+    void rasterize();
+
+    // World space box. Boxes crossing the near plane are always visible
+    bool isVisible(const vec3 &min, const vec3 &max);
+
+    const Stats &lastStats() const;
+
+    unsigned int getWidth() const;
+
+    unsigned int getHeight() const;
+
+    // Depth 0 (near) to 1 (far), row by row from the bottom. Level 0 is the full buffer, every level above holds the
+    // farthest depth of 2x2 texels of the one below
+    const float* getDepth(size_t level = 0) const;
+
+    size_t getLevelCount() const;
+
+    unsigned int getLevelWidth(size_t level) const;
+
+    unsigned int getLevelHeight(size_t level) const;
+
+private:
+    static const unsigned int BAND_HEIGHT = 16;
+
+    struct ScreenTriangle {
+        float x[3], y[3], z[3]; // Pixels and 0..1 depth
+        int minY, maxY;
+    };
+
+    struct Level {
+        unsigned int width;
+        unsigned int height;
+        std::vector<float> depth;
+    };
+
+    unsigned int width;
+    unsigned int height;
+    mat4 viewProjection;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<Level> levels; // 0 is the full buffer
+    Stats stats = {0, 0, 0, 0.0f};
+    JobSystem* jobs;
+
+    void rasterizeBand(unsigned int band);
+
+    void addClippedTriangle(const vec4 &a, const vec4 &b, const vec4 &c, bool twoSided);
+
+    void buildPyramid();
+};
+
+#endif //LEARNOPENGL_OCCLUSIONCULLER_H
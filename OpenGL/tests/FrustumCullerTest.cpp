@@ -0,0 +1,145 @@
+// Headless checks for the frustum culler: the plane tests, and that the BVH finds exactly what the linear pass finds
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../scene/FrustumCuller.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cout << "FAIL::FRUSTUM_CULLER " << what << std::endl;
+        failures++;
+    }
+}
+
+static mat4 camera(const vec3 &eye, const vec3 &target, float fovY = 1.0f) {
+    return mat4::perspective(fovY, 16.0f / 9.0f, 0.1f, 150.0f) * mat4::lookAt(eye, target, vec3(0.0f, 1.0f, 0.0f));
+}
+
+static void testFrustum() {
+    // At z = 5 looking down -z, the near plane is 0.1 away and the far one 150
+    Frustum frustum = Frustum::fromMatrix(camera(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f)));
+    check(frustum.containsSphere(vec3(0.0f), 0.5f), "sphere straight ahead is inside");
+    check(!frustum.containsSphere(vec3(0.0f, 0.0f, 10.0f), 1.0f), "sphere behind the camera is outside");
+    check(!frustum.containsSphere(vec3(0.0f, 0.0f, -200.0f), 1.0f), "sphere past the far plane is outside");
+    check(!frustum.containsSphere(vec3(50.0f, 0.0f, 0.0f), 1.0f), "sphere off to the side is outside");
+    check(frustum.containsSphere(vec3(50.0f, 0.0f, 0.0f), 60.0f), "big sphere reaching into the view is inside");
+
+    // Normalized planes: a point's value is its distance, so a sphere touching the plane from outside still counts
+    const vec4 &near = frustum.planes[4];
+    check(std::abs(length(near.xyz()) - 1.0f) < 1e-5f, "planes are normalized");
+    check(frustum.containsSphere(vec3(0.0f, 0.0f, 5.0f), 0.11f) && !frustum.containsSphere(vec3(0.0f, 0.0f, 5.0f), 0.09f),
+          "radius is measured against the plane distance");
+}
+
+// Sorted ids of the spheres inside, one at a time through Frustum::containsSphere
+static std::vector<unsigned int> reference(const Frustum &frustum, const std::vector<vec3> &centers,
+                                           const std::vector<float> &radii) {
+    std::vector<unsigned int> visible;
+    for (unsigned int id = 0; id < centers.size(); id++) {
+        if (frustum.containsSphere(centers[id], radii[id])) visible.push_back(id);
+    }
+    return visible;
+}
+
+static void testHierarchy() {
+    // 20k spheres in a 200 unit cube, an odd count so the SIMD loops leave a tail
+    const unsigned int count = 20003;
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f), size(0.1f, 3.0f);
+    std::vector<vec3> centers;
+    std::vector<float> radii;
+    FrustumCuller linear, hierarchy;
+    for (unsigned int i = 0; i < count; i++) {
+        vec3 center(position(random), position(random), position(random));
+        float radius = size(random);
+        centers.push_back(center);
+        radii.push_back(radius);
+        linear.add(center, radius);
+        hierarchy.add(center, radius);
+    }
+    hierarchy.buildHierarchy();
+    check(!linear.hasHierarchy() && hierarchy.hasHierarchy(), "only buildHierarchy makes a BVH");
+
+    // From the middle in several directions, from outside looking in, looking away and a narrow view
+    const mat4 views[] = {
+            camera(vec3(0.0f), vec3(1.0f, 0.0f, 0.0f)),
+            camera(vec3(0.0f), vec3(0.0f, 0.3f, -1.0f)),
+            camera(vec3(20.0f, -10.0f, 5.0f), vec3(-1.0f, 2.0f, 3.0f)),
+            camera(vec3(0.0f, 0.0f, 250.0f), vec3(0.0f)),
+            camera(vec3(0.0f, 0.0f, 250.0f), vec3(0.0f, 0.0f, 500.0f)),
+            camera(vec3(0.0f, 0.0f, 120.0f), vec3(0.0f), 0.1f),
+    };
+    bool sameAsReference = true, sameAsLinear = true, statsAdd = true, linearTestsAll = true, fewerTests = true;
+    bool acceptsWholeNodes = false;
+    std::vector<unsigned int> linearVisible, hierarchyVisible;
+    for (const mat4 &view : views) {
+        Frustum frustum = Frustum::fromMatrix(view);
+        linear.cull(frustum, linearVisible);
+        hierarchy.cull(frustum, hierarchyVisible);
+
+        // The linear pass keeps ids in order, the BVH in its own order
+        std::vector<unsigned int> expected = reference(frustum, centers, radii);
+        sameAsReference &= linearVisible == expected;
+        std::sort(hierarchyVisible.begin(), hierarchyVisible.end());
+        sameAsLinear &= hierarchyVisible == linearVisible;
+
+        const FrustumCuller::Stats &linearStats = linear.lastStats(), &hierarchyStats = hierarchy.lastStats();
+        statsAdd &= linearStats.objects == count && hierarchyStats.objects == count &&
+                    linearStats.culled == count - linearVisible.size() &&
+                    hierarchyStats.culled == count - hierarchyVisible.size();
+        linearTestsAll &= linearStats.tested == count && linearStats.nodesVisited == 0;
+        fewerTests &= hierarchyStats.tested < count / 2 && hierarchyStats.nodesVisited > 0;
+        acceptsWholeNodes |= hierarchyStats.tested < hierarchyVisible.size();
+    }
+    check(sameAsReference, "the SIMD pass matches testing the spheres one by one");
+    check(sameAsLinear, "the BVH finds the same spheres as the linear pass");
+    check(statsAdd, "culled is what's not visible");
+    check(linearTestsAll, "the linear pass tests every sphere");
+    check(fewerTests, "the BVH skips most of the sphere tests");
+    check(acceptsWholeNodes, "nodes fully inside are taken without sphere tests");
+
+    // Moving a sphere drops the BVH, the next cull sees the new place
+    Frustum ahead = Frustum::fromMatrix(views[0]);
+    const unsigned int moved = 0;
+    hierarchy.update(moved, vec3(1000.0f, 0.0f, 0.0f), 1.0f);
+    check(!hierarchy.hasHierarchy(), "update drops the BVH");
+    hierarchy.cull(ahead, hierarchyVisible);
+    check(std::find(hierarchyVisible.begin(), hierarchyVisible.end(), moved) == hierarchyVisible.end(),
+          "a sphere moved past the far plane is culled");
+    hierarchy.update(moved, vec3(10.0f, 0.0f, 0.0f), 1.0f);
+    hierarchy.buildHierarchy();
+    hierarchy.cull(ahead, hierarchyVisible);
+    check(std::find(hierarchyVisible.begin(), hierarchyVisible.end(), moved) != hierarchyVisible.end(),
+          "a sphere moved in front of the camera is visible");
+}
+
+static void testEmpty() {
+    FrustumCuller culler;
+    culler.buildHierarchy();
+    check(!culler.hasHierarchy(), "nothing to build a BVH over");
+    std::vector<unsigned int> visible(3, 0);
+    culler.cull(Frustum::fromMatrix(camera(vec3(0.0f), vec3(1.0f, 0.0f, 0.0f))), visible);
+    check(visible.empty() && culler.lastStats().objects == 0 && culler.lastStats().culled == 0,
+          "an empty culler clears the list and counts nothing");
+
+    // Fewer spheres than one leaf
+    culler.add(vec3(5.0f, 0.0f, 0.0f), 1.0f);
+    culler.add(vec3(-5.0f, 0.0f, 0.0f), 1.0f);
+    culler.buildHierarchy();
+    culler.cull(Frustum::fromMatrix(camera(vec3(0.0f), vec3(1.0f, 0.0f, 0.0f))), visible);
+    check(visible.size() == 1 && visible[0] == 0, "a single leaf BVH culls like the linear pass");
+}
+
+int main() {
+    testFrustum();
+    testHierarchy();
+    testEmpty();
+
+    if (failures == 0) std::cout << "FRUSTUM_CULLER::OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
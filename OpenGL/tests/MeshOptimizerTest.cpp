@@ -0,0 +1,172 @@
+// Headless checks for the mesh optimizer: the simulated cache numbers, and that every pass keeps the same triangles
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../geometry/MeshOptimizer.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cout << "FAIL::MESH_OPTIMIZER " << what << std::endl;
+        failures++;
+    }
+}
+
+// side x side vertices, 3 floats each plus one unused vertex at the end, triangles shuffled so the cache gets nothing
+static void shuffledGrid(unsigned int side, std::vector<float> &vertices, std::vector<unsigned int> &indices) {
+    for (unsigned int row = 0; row < side; row++) {
+        for (unsigned int column = 0; column < side; column++) {
+            vertices.insert(vertices.end(), {(float)column, (float)row, 0.0f});
+        }
+    }
+    vertices.insert(vertices.end(), {-1.0f, -1.0f, -1.0f});
+
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (unsigned int row = 0; row + 1 < side; row++) {
+        for (unsigned int column = 0; column + 1 < side; column++) {
+            unsigned int corner = row * side + column;
+            triangles.push_back({{corner, corner + 1, corner + side}});
+            triangles.push_back({{corner + 1, corner + side + 1, corner + side}});
+        }
+    }
+    std::mt19937 random(7);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (const auto &triangle : triangles) indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+// Triangles as vertex positions, each rotated to start at its smallest corner so the winding is kept, then sorted.
+// Two lists with the same result draw the same thing whatever the order and numbering
+static std::vector<std::array<float, 9>> triangleSet(const std::vector<float> &vertices,
+                                                     const std::vector<unsigned int> &indices) {
+    std::vector<std::array<float, 9>> set;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<std::array<float, 3>, 3> corners;
+        for (int corner = 0; corner < 3; corner++) {
+            for (int axis = 0; axis < 3; axis++) corners[corner][axis] = vertices[indices[i + corner] * 3 + axis];
+        }
+        auto first = std::min_element(corners.begin(), corners.end()) - corners.begin();
+        std::array<float, 9> triangle;
+        for (int corner = 0; corner < 3; corner++) {
+            for (int axis = 0; axis < 3; axis++) triangle[corner * 3 + axis] = corners[(first + corner) % 3][axis];
+        }
+        set.push_back(triangle);
+    }
+    std::sort(set.begin(), set.end());
+    return set;
+}
+
+static void testAnalyze() {
+    const unsigned int once[3] = {0, 1, 2};
+    MeshOptimizer::CacheStats single = MeshOptimizer::analyzeVertexCache(once, 3, 3);
+    check(single.acmr == 3.0f && single.atvr == 1.0f, "a lone triangle transforms all three vertices");
+
+    const unsigned int twice[6] = {0, 1, 2, 2, 1, 0};
+    MeshOptimizer::CacheStats repeated = MeshOptimizer::analyzeVertexCache(twice, 6, 3);
+    check(repeated.acmr == 1.5f && repeated.atvr == 1.0f, "the second triangle hits the cache");
+
+    // A cache of 3 can't hold the 4 vertices of two triangles that are drawn in turns
+    const unsigned int alternating[12] = {0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5};
+    MeshOptimizer::CacheStats thrashed = MeshOptimizer::analyzeVertexCache(alternating, 12, 6, 3);
+    check(thrashed.acmr == 3.0f && thrashed.atvr == 2.0f, "a small FIFO cache misses everything");
+}
+
+static void testOptimize() {
+    const unsigned int side = 64;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    shuffledGrid(side, vertices, indices);
+    std::vector<float> originalVertices = vertices;
+    std::vector<unsigned int> originalIndices = indices;
+
+    MeshOptimizer::Report report = MeshOptimizer::optimize(vertices, 3, indices);
+    std::cout << "MESH_OPTIMIZER grid ACMR " << report.before.acmr
+              << " -> " << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+              << std::endl;
+
+    check(report.before.acmr > 1.5f, "a shuffled grid gets little reuse");
+    check(report.after.acmr < 0.8f, "optimized grid gets close to the 0.5 ideal");
+    check(report.after.atvr < report.before.atvr && report.after.atvr >= 1.0f, "fewer vertices are transformed again");
+    check(report.vertexCount == side * side, "the unused vertex is dropped");
+    check(vertices.size() == report.vertexCount * 3, "vertices are cut to what's kept");
+    check(report.indexSize == 2, "4096 vertices fit 16 bit indices");
+    check(indices.size() == originalIndices.size(), "no triangle is lost");
+    check(triangleSet(vertices, indices) == triangleSet(originalVertices, originalIndices),
+          "same triangles with the same winding");
+
+    // Fetch order: every vertex is first used right after the one before it
+    unsigned int next = 0;
+    bool firstUse = true;
+    for (unsigned int index : indices) {
+        if (index == next) next++;
+        else firstUse &= index < next;
+    }
+    check(firstUse && next == report.vertexCount, "vertices are numbered by first use");
+
+    MeshOptimizer::CacheStats measured = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(),
+                                                                           report.vertexCount);
+    check(measured.acmr == report.after.acmr, "the report matches the returned indices");
+}
+
+// The overdraw pass needs faces pointing different ways to do anything, a sphere has all of them
+static void testOverdraw() {
+    const unsigned int rings = 32, segments = 48;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (unsigned int ring = 0; ring <= rings; ring++) {
+        float polar = 3.14159265f * (float)ring / (float)rings;
+        for (unsigned int segment = 0; segment <= segments; segment++) {
+            float azimuth = 2.0f * 3.14159265f * (float)segment / (float)segments;
+            vertices.insert(vertices.end(), {std::sin(polar) * std::cos(azimuth), std::cos(polar),
+                                             std::sin(polar) * std::sin(azimuth)});
+        }
+    }
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (unsigned int ring = 0; ring < rings; ring++) {
+        for (unsigned int segment = 0; segment < segments; segment++) {
+            unsigned int corner = ring * (segments + 1) + segment;
+            triangles.push_back({{corner, corner + segments + 1, corner + 1}});
+            triangles.push_back({{corner + 1, corner + segments + 1, corner + segments + 2}});
+        }
+    }
+    std::mt19937 random(11);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (const auto &triangle : triangles) indices.insert(indices.end(), triangle.begin(), triangle.end());
+
+    std::vector<float> cacheVertices = vertices, overdrawVertices = vertices;
+    std::vector<unsigned int> cacheIndices = indices, overdrawIndices = indices;
+    MeshOptimizer::Report cacheOnly = MeshOptimizer::optimize(cacheVertices, 3, cacheIndices);
+    MeshOptimizer::Report withOverdraw = MeshOptimizer::optimize(overdrawVertices, 3, overdrawIndices, true);
+    std::cout << "MESH_OPTIMIZER sphere ACMR " << cacheOnly.before.acmr << " -> " << cacheOnly.after.acmr
+              << ", with overdraw " << withOverdraw.after.acmr << std::endl;
+
+    check(overdrawIndices != cacheIndices, "overdraw order moves clusters around");
+    check(withOverdraw.after.acmr < cacheOnly.before.acmr, "overdraw order still helps the cache");
+    check(withOverdraw.after.acmr <= cacheOnly.after.acmr * 1.1f, "overdraw order costs little cache efficiency");
+    check(triangleSet(overdrawVertices, overdrawIndices) == triangleSet(vertices, indices),
+          "overdraw order keeps the same triangles with the same winding");
+}
+
+static void testIndexSize() {
+    // 0xFFFF stays free for primitive restart
+    check(MeshOptimizer::indexSize(65534) == 2, "65534 vertices fit 16 bit indices");
+    check(MeshOptimizer::indexSize(65535) == 4, "one more would need the restart index");
+
+    const unsigned int indices[3] = {0, 1, 65533};
+    std::vector<unsigned char> packed = MeshOptimizer::packIndices(indices, 3, 2);
+    check(packed.size() == 6 && packed[4] == 0xFD && packed[5] == 0xFF, "indices pack to 2 bytes each");
+}
+
+int main() {
+    testAnalyze();
+    testOptimize();
+    testOverdraw();
+    testIndexSize();
+
+    if (failures == 0) std::cout << "MESH_OPTIMIZER::OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Headless checks for the software occlusion culler, no GL or window needed
+
+#include <iostream>
+#include "../scene/OcclusionCuller.h"
+#include "../core/JobSystem.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cout << "FAIL::OCCLUSION " << what << std::endl;
+        failures++;
+    }
+}
+
+// Camera at z = 5 looking down -z, a 2x2 quad at the origin as occluder
+static mat4 camera() {
+    return mat4::perspective(1.0f, 2.0f, 0.1f, 100.0f) * mat4::lookAt(vec3(0, 0, 5), vec3(0, 0, 0), vec3(0, 1, 0));
+}
+
+static const vec3 quad[4] = {vec3(-1, -1, 0), vec3(1, -1, 0), vec3(1, 1, 0), vec3(-1, 1, 0)};
+static const unsigned int counterClockwise[6] = {0, 1, 2, 0, 2, 3};
+static const unsigned int clockwise[6] = {0, 2, 1, 0, 3, 2};
+
+static void testWinding(JobSystem* jobs) {
+    OcclusionCuller culler(256, 128, jobs);
+
+    culler.beginFrame(camera());
+    culler.addOccluder(mat4::identity(), quad, counterClockwise, 6);
+    culler.rasterize();
+    check(culler.lastStats().occluderTriangles == 2, "front facing quad is rasterized");
+    check(!culler.isVisible(vec3(-0.3f, -0.3f, -3), vec3(0.3f, 0.3f, -2)), "box behind the quad is hidden");
+    check(culler.isVisible(vec3(-0.3f, -0.3f, 1), vec3(0.3f, 0.3f, 2)), "box in front of the quad is visible");
+    check(culler.isVisible(vec3(0.8f, -0.3f, -3), vec3(1.6f, 0.3f, -2)), "box sticking out the side is visible");
+    check(culler.lastStats().tested == 3 && culler.lastStats().occluded == 1, "stats count the tests");
+
+    culler.beginFrame(camera());
+    culler.addOccluder(mat4::identity(), quad, clockwise, 6);
+    culler.rasterize();
+    check(culler.lastStats().occluderTriangles == 0, "back facing quad is dropped");
+    check(culler.isVisible(vec3(-0.3f, -0.3f, -3), vec3(0.3f, 0.3f, -2)), "nothing hides behind a back face");
+
+    culler.beginFrame(camera());
+    culler.addOccluder(mat4::identity(), quad, clockwise, 6, true);
+    culler.rasterize();
+    check(culler.lastStats().occluderTriangles == 2, "two sided quad is rasterized either way");
+    check(!culler.isVisible(vec3(-0.3f, -0.3f, -3), vec3(0.3f, 0.3f, -2)), "box behind a two sided quad is hidden");
+}
+
+// Same setup as Application: identity camera, the clockwise triangle in front of a grid cell
+static void testApplicationTriangle() {
+    const vec3 triangle[3] = {vec3(0.5f, -0.5f, 0.0f), vec3(-0.5f, -0.5f, 0.0f), vec3(0.0f, 0.5f, 0.0f)};
+    const unsigned int indices[3] = {0, 1, 2};
+    const float cellExtent = 0.03f * 0.71f + 0.01f;
+
+    OcclusionCuller culler(256, 128);
+    culler.beginFrame(mat4::identity());
+    culler.addOccluder(mat4::translate(vec3(0.0f, 0.0f, -0.5f)), triangle, indices, 3, true);
+    culler.rasterize();
+    check(culler.lastStats().occluderTriangles == 1, "application triangle is rasterized");
+    check(!culler.isVisible(vec3(-cellExtent, -cellExtent, 0.0f), vec3(cellExtent, cellExtent, 0.0f)),
+          "grid cell behind the application triangle is hidden");
+    check(culler.isVisible(vec3(0.8f - cellExtent, 0.8f - cellExtent, 0.0f), vec3(0.8f + cellExtent, 0.8f + cellExtent, 0.0f)),
+          "grid cell in the corner is visible");
+}
+
+static void testPyramid() {
+    OcclusionCuller culler(256, 128);
+    culler.beginFrame(camera());
+    culler.addOccluder(mat4::identity(), quad, counterClockwise, 6);
+    culler.rasterize();
+
+    // Every texel is the farthest of the 2x2 below it, down to a single one
+    size_t levels = culler.getLevelCount();
+    check(culler.getLevelWidth(levels - 1) == 1 && culler.getLevelHeight(levels - 1) == 1, "pyramid ends at 1x1");
+    bool farthest = true;
+    for (size_t level = 1; level < levels; level++) {
+        const float* below = culler.getDepth(level - 1);
+        const float* depth = culler.getDepth(level);
+        unsigned int belowWidth = culler.getLevelWidth(level - 1), belowHeight = culler.getLevelHeight(level - 1);
+        for (unsigned int y = 0; y < culler.getLevelHeight(level); y++) {
+            for (unsigned int x = 0; x < culler.getLevelWidth(level); x++) {
+                float expected = 0.0f;
+                for (unsigned int child = 0; child < 4; child++) {
+                    unsigned int childX = std::min(x * 2 + (child & 1), belowWidth - 1);
+                    unsigned int childY = std::min(y * 2 + (child >> 1), belowHeight - 1);
+                    expected = std::max(expected, below[childY * belowWidth + childX]);
+                }
+                farthest &= depth[y * culler.getLevelWidth(level) + x] == expected;
+            }
+        }
+    }
+    check(farthest, "pyramid levels hold the farthest depth of their 2x2");
+
+    // The quad covers the middle of the buffer, the corners stay cleared
+    const float* depth = culler.getDepth();
+    unsigned int width = culler.getWidth(), height = culler.getHeight();
+    check(depth[(height / 2) * width + width / 2] < 1.0f, "quad covers the centre");
+    check(depth[0] == 1.0f, "corner is cleared to far");
+    check(culler.getDepth(levels - 1)[0] == 1.0f, "top of the pyramid is far while anything is uncovered");
+}
+
+static void testNearPlane() {
+    // Occluder reaching behind the camera gets clipped, not dropped
+    OcclusionCuller culler(256, 128);
+    mat4 projection = mat4::perspective(1.0f, 2.0f, 0.1f, 100.0f);
+    const vec3 floor[3] = {vec3(-50, -50, 1), vec3(50, -50, -50), vec3(0, 50, -50)};
+    const unsigned int indices[3] = {0, 1, 2};
+    culler.beginFrame(projection);
+    culler.addOccluder(mat4::identity(), floor, indices, 3, true);
+    culler.rasterize();
+    check(culler.lastStats().occluderTriangles == 2, "triangle crossing the near plane is clipped into two");
+
+    // A box partly behind the near plane is always visible, even right behind an occluder
+    culler.beginFrame(camera());
+    culler.addOccluder(mat4::identity(), quad, counterClockwise, 6);
+    culler.rasterize();
+    check(culler.isVisible(vec3(-0.3f, -0.3f, -3), vec3(0.3f, 0.3f, 6)), "box crossing the near plane is visible");
+}
+
+int main() {
+    testWinding(nullptr);
+    {
+        JobSystem jobs(3);
+        testWinding(&jobs);
+    }
+    testApplicationTriangle();
+    testPyramid();
+    testNearPlane();
+
+    if (failures == 0) std::cout << "OCCLUSION::OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// Headless checks for the TLSF range allocator. Random allocations, frees and defragments against a shadow copy of
+// the space that records which handle owns every unit, so any overlap or lost range shows up
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../memory/RangeAllocator.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cout << "FAIL::RANGE_ALLOCATOR " << what << std::endl;
+        failures++;
+    }
+}
+
+static const uint32_t FREE = RangeAllocator::INVALID;
+
+// Owner of every unit, what a GL buffer behind the allocator would hold
+struct Shadow {
+    std::vector<uint32_t> owner;
+    std::vector<uint32_t> live; // Handles currently allocated
+    uint32_t used = 0;
+
+    explicit Shadow(uint32_t capacity) : owner(capacity, FREE) {}
+
+    bool claim(const RangeAllocator &allocator, uint32_t handle) {
+        uint32_t offset = allocator.offsetOf(handle), size = allocator.sizeOf(handle);
+        if (offset + size > owner.size()) return false;
+        bool free = std::all_of(owner.begin() + offset, owner.begin() + offset + size,
+                                [](uint32_t unit) { return unit == FREE; });
+        std::fill(owner.begin() + offset, owner.begin() + offset + size, handle);
+        live.push_back(handle);
+        used += size;
+        return free;
+    }
+
+    void release(const RangeAllocator &allocator, uint32_t handle) {
+        uint32_t offset = allocator.offsetOf(handle), size = allocator.sizeOf(handle);
+        std::fill(owner.begin() + offset, owner.begin() + offset + size, FREE);
+        live.erase(std::find(live.begin(), live.end(), handle));
+        used -= size;
+    }
+
+    // Every live handle still finds only itself in its range
+    bool intact(const RangeAllocator &allocator) const {
+        for (uint32_t handle : live) {
+            uint32_t offset = allocator.offsetOf(handle), size = allocator.sizeOf(handle);
+            if (offset + size > owner.size()) return false;
+            for (uint32_t unit = offset; unit < offset + size; unit++) {
+                if (owner[unit] != handle) return false;
+            }
+        }
+        return (uint32_t)std::count_if(owner.begin(), owner.end(), [](uint32_t unit) { return unit != FREE; }) == used;
+    }
+};
+
+static void testBasics() {
+    RangeAllocator allocator(1000);
+    uint32_t all = allocator.allocate(1000);
+    check(all != RangeAllocator::INVALID && allocator.offsetOf(all) == 0, "the whole space fits one allocation");
+    check(allocator.allocate(1) == RangeAllocator::INVALID, "nothing fits in a full space");
+    allocator.free(all);
+
+    uint32_t a = allocator.allocate(100), b = allocator.allocate(200), c = allocator.allocate(300);
+    check(allocator.allocate(1000) == RangeAllocator::INVALID, "too big for what's left");
+    allocator.free(b);
+    check(allocator.stats().freeBlocks == 2, "a hole in the middle is its own free block");
+    allocator.free(a);
+    allocator.free(c);
+    RangeAllocator::Stats stats = allocator.stats();
+    check(stats.freeBlocks == 1 && stats.largestFree == 1000 && stats.used == 0 && stats.allocations == 0,
+          "freed neighbours merge back into one block");
+    check(stats.fragmentation == 0.0f, "one free block isn't fragmented");
+}
+
+static void testRandom(uint32_t seed) {
+    const uint32_t capacity = 1 << 16;
+    RangeAllocator allocator(capacity);
+    Shadow shadow(capacity);
+    std::mt19937 random(seed);
+    bool overlapFree = true, intact = true, statsMatch = true, movesDown = true, compacted = true;
+    int failedAllocations = 0;
+
+    for (int step = 0; step < 20000; step++) {
+        uint32_t roll = random() % 100;
+        if (roll < 55 || shadow.live.empty()) {
+            // Mostly small ranges with the odd big one, like meshes
+            uint32_t size = roll % 10 == 0 ? 1 + random() % 4096 : 1 + random() % 256;
+            uint32_t handle = allocator.allocate(size);
+            if (handle == RangeAllocator::INVALID) {
+                failedAllocations++;
+                // Only allowed when no free block of that size exists
+                statsMatch &= allocator.stats().largestFree < size;
+                continue;
+            }
+            statsMatch &= allocator.sizeOf(handle) >= size;
+            overlapFree &= shadow.claim(allocator, handle);
+        } else if (roll < 98) {
+            uint32_t handle = shadow.live[random() % shadow.live.size()];
+            shadow.release(allocator, handle);
+            allocator.free(handle);
+        } else {
+            // Carry the moves out on the shadow like BufferArena does on the buffer, in the order they come
+            std::vector<RangeAllocator::Move> moves = allocator.defragment();
+            for (const RangeAllocator::Move &move : moves) {
+                movesDown &= move.to < move.from;
+                std::vector<uint32_t> moved(shadow.owner.begin() + move.from, shadow.owner.begin() + move.from + move.size);
+                std::fill(shadow.owner.begin() + move.from, shadow.owner.begin() + move.from + move.size, FREE);
+                std::copy(moved.begin(), moved.end(), shadow.owner.begin() + move.to);
+            }
+            RangeAllocator::Stats stats = allocator.stats();
+            compacted &= stats.freeBlocks <= 1 && stats.fragmentation == 0.0f &&
+                         stats.largestFree == capacity - stats.used;
+        }
+
+        if (step % 64 == 0) {
+            intact &= shadow.intact(allocator);
+            RangeAllocator::Stats stats = allocator.stats();
+            statsMatch &= stats.used == shadow.used && stats.allocations == shadow.live.size() &&
+                          stats.capacity == capacity && stats.largestFree <= capacity - stats.used;
+        }
+    }
+
+    check(overlapFree, "no allocation overlaps another");
+    check(intact && shadow.intact(allocator), "every range keeps its contents through frees and defragments");
+    check(statsMatch, "stats agree with the shadow");
+    check(movesDown, "defragment only moves ranges down");
+    check(compacted, "after defragment the free space is one block at the end");
+    check(failedAllocations > 0, "the random run gets the space full at times");
+
+    // Free everything, the space has to come back whole
+    while (!shadow.live.empty()) {
+        uint32_t handle = shadow.live.back();
+        shadow.release(allocator, handle);
+        allocator.free(handle);
+    }
+    RangeAllocator::Stats stats = allocator.stats();
+    check(stats.used == 0 && stats.freeBlocks == 1 && stats.largestFree == capacity, "all free again is one block");
+}
+
+int main() {
+    testBasics();
+    for (uint32_t seed = 1; seed <= 4; seed++) testRandom(seed);
+
+    if (failures == 0) std::cout << "RANGE_ALLOCATOR::OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}